@@ -11,8 +11,46 @@
 #include "SurfaceLock.h"
 #include "PixelTool.h"
 #include "Random.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
 
 const char *EffectDisintegrate::NAME = "disintegrate";
+
+namespace {
+/**
+ * Draw only some pixels of rows.
+ * Random::aByte only reads a prepared table.
+ */
+class DisintegrateRows : public RowTask {
+    private:
+        SDL_Surface *m_screen;
+        SDL_Surface *m_surface;
+        int m_disint;
+        int m_x;
+        int m_y;
+    public:
+        DisintegrateRows(SDL_Surface *screen, SDL_Surface *surface,
+                int disint, int x, int y)
+            : m_screen(screen), m_surface(surface), m_disint(disint),
+            m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            for (int py = begin; py < end; ++py) {
+                for (int px = 0; px < m_surface->w; ++px) {
+                    if (Random::aByte(py * m_surface->w + px) < m_disint) {
+                        SDL_Color pixel =
+                            PixelTool::getColor(m_surface, px, py);
+                        if (pixel.unused == 255) {
+                            PixelTool::putColor(m_screen,
+                                    m_x + px, m_y + py, pixel);
+                        }
+                    }
+                }
+            }
+        }
+};
+}
+
 //-----------------------------------------------------------------
 /**
  * Start as not disintegrated.
@@ -59,15 +97,7 @@ EffectDisintegrate::blit(SDL_Surface *screen, SDL_Surface *surface,
     SurfaceLock lock1(screen);
     SurfaceLock lock2(surface);
 
-    for (int py = 0; py < surface->h; ++py) {
-        for (int px = 0; px < surface->w; ++px) {
-            if (Random::aByte(py * surface->w + px) < m_disint) {
-                SDL_Color pixel = PixelTool::getColor(surface, px, py);
-                if (pixel.unused == 255) {
-                    PixelTool::putColor(screen, x + px, y + py, pixel);
-                }
-            }
-        }
-    }
+    DisintegrateRows task(screen, surface, m_disint, x, y);
+    WorkerPool::forRows(&task, surface->h, surface->w * surface->h);
 }
 
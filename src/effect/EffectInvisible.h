@@ -11,6 +11,8 @@ class EffectInvisible : public ViewEffect {
         static const char *NAME;
         virtual const char* getName() const { return NAME; }
         virtual bool isInvisible() const { return true; }
+        virtual bool isStatic() const { return true; }
+        virtual bool canTrim() const { return true; }
         virtual void blit(SDL_Surface *, SDL_Surface *, int, int) {}
 };
 
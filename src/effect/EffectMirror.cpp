@@ -10,8 +10,53 @@
 
 #include "SurfaceLock.h"
 #include "PixelTool.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
 
 const char *EffectMirror::NAME = "mirror";
+
+namespace {
+/**
+ * Draw mirror rows.
+ * Each row reads only screen pixels from the same row.
+ */
+class MirrorRows : public RowTask {
+    private:
+        SDL_Surface *m_screen;
+        SDL_Surface *m_surface;
+        SDL_Color m_mask;
+        int m_border;
+        int m_x;
+        int m_y;
+    public:
+        MirrorRows(SDL_Surface *screen, SDL_Surface *surface,
+                const SDL_Color &mask, int border, int x, int y)
+            : m_screen(screen), m_surface(surface), m_mask(mask),
+            m_border(border), m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            for (int py = begin; py < end; ++py) {
+                for (int px = 0; px < m_surface->w; ++px) {
+                    SDL_Color pixel = PixelTool::getColor(m_surface, px, py);
+                    if (px > m_border
+                            && PixelTool::colorEquals(pixel, m_mask)) {
+                        SDL_Color sample = PixelTool::getColor(m_screen,
+                                m_x - px + m_border, m_y + py);
+                        PixelTool::putColor(m_screen,
+                                m_x + px, m_y + py, sample);
+                    }
+                    else {
+                        if (pixel.unused == 255) {
+                            PixelTool::putColor(m_screen,
+                                    m_x + px, m_y + py, pixel);
+                        }
+                    }
+                }
+            }
+        }
+};
+}
+
 //-----------------------------------------------------------------
 /**
  * Mirror effect. Draw left side inside.
@@ -27,20 +72,7 @@ EffectMirror::blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y)
     SDL_Color mask = PixelTool::getColor(surface,
             surface->w / 2, surface->h / 2);
 
-    for (int py = 0; py < surface->h; ++py) {
-        for (int px = 0; px < surface->w; ++px) {
-            SDL_Color pixel = PixelTool::getColor(surface, px, py);
-            if (px > MIRROR_BORDER && PixelTool::colorEquals(pixel, mask)) {
-                SDL_Color sample = PixelTool::getColor(screen,
-                        x - px + MIRROR_BORDER, y + py);
-                PixelTool::putColor(screen, x + px, y + py, sample);
-            }
-            else {
-                if (pixel.unused == 255) {
-                    PixelTool::putColor(screen, x + px, y + py, pixel);
-                }
-            }
-        }
-    }
+    MirrorRows task(screen, surface, mask, MIRROR_BORDER, x, y);
+    WorkerPool::forRows(&task, surface->h, surface->w * surface->h);
 }
 
@@ -8,6 +8,8 @@
  */
 #include "EffectNone.h"
 
+#include "SurfaceTool.h"
+
 const char *EffectNone::NAME = "none";
 //-----------------------------------------------------------------
 /**
@@ -22,3 +24,12 @@ EffectNone::blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y)
     SDL_BlitSurface(surface, NULL, screen, &rect);
 }
 
+//-----------------------------------------------------------------
+/**
+ * Compose surface over a transparent layer.
+ */
+void
+EffectNone::blitOver(SDL_Surface *layer, SDL_Surface *surface, int x, int y)
+{
+    SurfaceTool::blitOver(layer, surface, x, y);
+}
@@ -10,8 +10,12 @@ class EffectNone : public ViewEffect {
     public:
         static const char *NAME;
         virtual const char* getName() const { return NAME; }
+        virtual bool isStatic() const { return true; }
+        virtual bool canTrim() const { return true; }
         virtual void blit(SDL_Surface *screen, SDL_Surface *surface,
                 int x, int y);
+        virtual void blitOver(SDL_Surface *layer, SDL_Surface *surface,
+                int x, int y);
 };
 
 #endif
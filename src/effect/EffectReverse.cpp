@@ -10,8 +10,39 @@
 
 #include "SurfaceLock.h"
 #include "PixelTool.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
 
 const char *EffectReverse::NAME = "reverse";
+
+namespace {
+/**
+ * Draw reversed rows.
+ */
+class ReverseRows : public RowTask {
+    private:
+        SDL_Surface *m_screen;
+        SDL_Surface *m_surface;
+        int m_x;
+        int m_y;
+    public:
+        ReverseRows(SDL_Surface *screen, SDL_Surface *surface, int x, int y)
+            : m_screen(screen), m_surface(surface), m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            for (int py = begin; py < end; ++py) {
+                for (int px = 0; px < m_surface->w; ++px) {
+                    SDL_Color pixel = PixelTool::getColor(m_surface, px, py);
+                    if (pixel.unused == 255) {
+                        PixelTool::putColor(m_screen,
+                                m_x + m_surface->w - 1 - px, m_y + py, pixel);
+                    }
+                }
+            }
+        }
+};
+}
+
 //-----------------------------------------------------------------
 /**
  * Reverse left and right.
@@ -22,14 +53,7 @@ EffectReverse::blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y)
     SurfaceLock lock1(screen);
     SurfaceLock lock2(surface);
 
-    for (int py = 0; py < surface->h; ++py) {
-        for (int px = 0; px < surface->w; ++px) {
-            SDL_Color pixel = PixelTool::getColor(surface, px, py);
-            if (pixel.unused == 255) {
-                PixelTool::putColor(screen,
-                        x + surface->w - 1 - px, y + py, pixel);
-            }
-        }
-    }
+    ReverseRows task(screen, surface, x, y);
+    WorkerPool::forRows(&task, surface->h, surface->w * surface->h);
 }
 
@@ -10,6 +10,7 @@ class EffectReverse : public ViewEffect {
     public:
         static const char *NAME;
         virtual const char* getName() const { return NAME; }
+        virtual bool isStatic() const { return true; }
         virtual void blit(SDL_Surface *screen, SDL_Surface *surface,
                 int x, int y);
 };
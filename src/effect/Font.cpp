@@ -13,38 +13,39 @@
 #include "TTFException.h"
 #include "SDLException.h"
 #include "Outline.h"
+#include "TextCache.h"
+#include "StringTool.h"
 
 #ifdef HAVE_FRIBIDI
 #include "fribidi.h"
+#include <vector>
 #endif
 
+TextCache *Font::ms_textCache = NULL;
+
 std::string
 Font::biditize(const std::string &text)
 {
 #ifdef HAVE_FRIBIDI
     FriBidiCharType base = FRIBIDI_TYPE_ON;
-    FriBidiChar *logicalString = new FriBidiChar[text.length() + 1];
-    FriBidiChar *visualString = new FriBidiChar[text.length() + 1];
+    std::vector<FriBidiChar> logicalString(text.length() + 1);
+    std::vector<FriBidiChar> visualString(text.length() + 1);
 
     int ucsLength = fribidi_charset_to_unicode(FRIBIDI_CHAR_SET_UTF8,
             const_cast<char*>(text.c_str()),
-            text.length(), logicalString);
-    fribidi_boolean ok = fribidi_log2vis(logicalString, ucsLength, &base,
-            visualString, NULL, NULL, NULL);
+            text.length(), &logicalString[0]);
+    fribidi_boolean ok = fribidi_log2vis(&logicalString[0], ucsLength, &base,
+            &visualString[0], NULL, NULL, NULL);
     if (!ok) {
         LOG_WARNING(ExInfo("cannot biditize text")
                 .addInfo("text", text));
         return text;
     }
 
-    char *buffer = new char[text.length() + 1];
+    std::vector<char> buffer(text.length() + 1);
     int length = fribidi_unicode_to_charset(FRIBIDI_CHAR_SET_UTF8,
-            visualString, ucsLength, buffer);
-    std::string result = std::string(buffer, length);
-    delete[] buffer;
-    delete[] visualString;
-    delete[] logicalString;
-    return result;
+            &visualString[0], ucsLength, &buffer[0]);
+    return std::string(&buffer[0], length);
 #else
     return text;
 #endif
@@ -69,6 +70,7 @@ Font::Font(const Path &file_ttf, int height)
     //NOTE: bg color will be set to be transparent
     SDL_Color bg = {10, 10, 10, 0};
     m_bg = bg;
+    m_key = file_ttf.getPosixName() + ":" + StringTool::toString(height);
 }
 //-----------------------------------------------------------------
 Font::~Font()
@@ -86,6 +88,7 @@ Font::init()
     if (TTF_Init() < 0) {
         throw TTFException(ExInfo("Init"));
     }
+    ms_textCache = new TextCache(TEXT_CACHE_SIZE);
 }
 //-----------------------------------------------------------------
 /**
@@ -94,6 +97,13 @@ Font::init()
 void
 Font::shutdown()
 {
+    if (ms_textCache) {
+        LOG_INFO(ExInfo("text cache")
+                .addInfo("hits", ms_textCache->getHits())
+                .addInfo("misses", ms_textCache->getMisses()));
+        delete ms_textCache;
+        ms_textCache = NULL;
+    }
     TTF_Quit();
 }
 
@@ -149,21 +159,48 @@ Font::renderText(const std::string &text, const SDL_Color &color) const
 //-----------------------------------------------------------------
 /**
  * Render text with black outline around font.
+ * Rendered texts are shared through the text cache,
+ * the returned surface must not be modified.
+ *
  * @param text utf-8 encoded text
  * @param color text color
  * @param outlineWidth outline width
- * @return new rendered surface
+ * @return rendered surface, free it after use
  */
 SDL_Surface *
 Font::renderTextOutlined(const std::string &text,
                 const SDL_Color &color, int outlineWidth) const
 {
     static const SDL_Color BLACK = {0, 0, 0, 255};
+    std::string key;
+    if (ms_textCache) {
+        key = getCacheKey(text, color, outlineWidth);
+        SDL_Surface *cached = ms_textCache->get(key);
+        if (cached) {
+            return cached;
+        }
+    }
+
     //NOTE: uses spaces to ensure space for outline
     SDL_Surface *surface = renderText(" " + text + " ", color);
     Outline outline(BLACK, outlineWidth);
 
     outline.drawOnColorKey(surface);
+    if (ms_textCache) {
+        ms_textCache->put(key, surface);
+    }
     return surface;
 }
+//-----------------------------------------------------------------
+/**
+ * Identify rendered text by font, color, outline and content.
+ */
+std::string
+Font::getCacheKey(const std::string &text,
+                const SDL_Color &color, int outlineWidth) const
+{
+    Uint32 rgb = (color.r << 16) | (color.g << 8) | color.b;
+    return m_key + "|" + StringTool::toString(rgb)
+        + "|" + StringTool::toString(outlineWidth) + "|" + text;
+}
 
@@ -2,6 +2,7 @@
 #define HEADER_FONT_H
 
 class Path;
+class TextCache;
 
 #include "NoCopy.h"
 
@@ -15,10 +16,15 @@ class Path;
  */
 class Font : public NoCopy {
     private:
+        static const unsigned int TEXT_CACHE_SIZE = 256;
+        static TextCache *ms_textCache;
         TTF_Font *m_ttfont;
         SDL_Color m_bg;
+        std::string m_key;
     private:
         static std::string biditize(const std::string &text);
+        std::string getCacheKey(const std::string &text,
+                const SDL_Color &color, int outlineWidth) const;
     public:
         Font(const Path &file_ttf, int height);
         ~Font();
@@ -13,6 +13,48 @@
 #include "ResourceException.h"
 #include "SurfaceLock.h"
 #include "PixelTool.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
+
+namespace {
+/**
+ * Draw lower layer pixels under the active mask color.
+ */
+class HighlightRows : public RowTask {
+    private:
+        SDL_Surface *m_screen;
+        SDL_Surface *m_lowerLayer;
+        SDL_Surface *m_colorMask;
+        Uint32 m_activeColor;
+        int m_x;
+        int m_y;
+    public:
+        HighlightRows(SDL_Surface *screen, SDL_Surface *lowerLayer,
+                SDL_Surface *colorMask, Uint32 activeColor, int x, int y)
+            : m_screen(screen), m_lowerLayer(lowerLayer),
+            m_colorMask(colorMask), m_activeColor(activeColor),
+            m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            //TODO: support alpha channels
+            for (int py = begin; py < end; ++py) {
+                int world_y = m_y + py;
+                for (int px = 0; px < m_colorMask->w; ++px) {
+                    Uint32 sample = PixelTool::getPixel(m_colorMask, px, py);
+
+                    if (sample == m_activeColor) {
+                        SDL_Color lower =
+                            PixelTool::getColor(m_lowerLayer, px, py);
+                        if (lower.unused == 255) {
+                            PixelTool::putColor(m_screen,
+                                    m_x + px, world_y, lower);
+                        }
+                    }
+                }
+            }
+        }
+};
+}
 
 //-----------------------------------------------------------------
 /**
@@ -90,20 +132,9 @@ LayeredPicture::drawOn(SDL_Surface *screen)
     SurfaceLock lock2(m_lowerLayer);
     SurfaceLock lock3(m_colorMask);
 
-    //TODO: support alpha channels
-    for (int py = 0; py < m_colorMask->h; ++py) {
-        int world_y = m_loc.getY() + py;
-        for (int px = 0; px < m_colorMask->w; ++px) {
-            Uint32 sample = PixelTool::getPixel(m_colorMask, px, py);
-
-            if (sample == m_activeColor) {
-                SDL_Color lower = PixelTool::getColor(m_lowerLayer, px, py);
-                if (lower.unused == 255) {
-                    PixelTool::putColor(screen,
-                            m_loc.getX() + px, world_y, lower);
-                }
-            }
-        }
-    }
+    HighlightRows task(screen, m_lowerLayer, m_colorMask, m_activeColor,
+            m_loc.getX(), m_loc.getY());
+    WorkerPool::forRows(&task, m_colorMask->h,
+            m_colorMask->w * m_colorMask->h);
 }
 
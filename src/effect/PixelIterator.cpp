@@ -56,8 +56,13 @@ SDL_Color
 PixelIterator::getColor() const
 {
     SDL_Color color;
-    SDL_GetRGBA(getPixel(), m_surface->format,
+    Uint32 pixel = getPixel();
+    SDL_GetRGBA(pixel, m_surface->format,
             &color.r, &color.g, &color.b, &color.unused);
+    if ((m_surface->flags & SDL_SRCCOLORKEY)
+            && pixel == m_surface->format->colorkey) {
+        color.unused = 0;
+    }
     return color;
 }
 //-----------------------------------------------------------------
@@ -34,14 +34,20 @@ PixelTool::convertColor(SDL_PixelFormat *format, const SDL_Color &color)
 /**
  * Get color at x, y.
  * Surface must be locked.
+ * Colorkey pixels have zero alpha.
  * @return color
  */
 SDL_Color
 PixelTool::getColor(SDL_Surface *surface, int x, int y)
 {
     SDL_Color color;
-    SDL_GetRGBA(getPixel(surface, x, y), surface->format,
+    Uint32 pixel = getPixel(surface, x, y);
+    SDL_GetRGBA(pixel, surface->format,
             &color.r, &color.g, &color.b, &color.unused);
+    if ((surface->flags & SDL_SRCCOLORKEY)
+            && pixel == surface->format->colorkey) {
+        color.unused = 0;
+    }
     return color;
 }
 //-----------------------------------------------------------------
@@ -78,12 +84,15 @@ PixelTool::getPixel(SDL_Surface *surface, int x, int y)
 //-----------------------------------------------------------------
 /**
  * Put pixel at x, y.
+ * Pixels outside the clip rect are ignored.
  * Surface must be locked.
  */
     void
 PixelTool::putPixel(SDL_Surface *surface, int x, int y, Uint32 pixel)
 {
-    if ((0 <= x && x < surface->w) && (0 <= y && y < surface->h)) {
+    const SDL_Rect &clip = surface->clip_rect;
+    if ((clip.x <= x && x < clip.x + clip.w)
+            && (clip.y <= y && y < clip.y + clip.h)) {
         int bpp = surface->format->BytesPerPixel;
         Uint8 *p = static_cast<Uint8*>(surface->pixels) + y * surface->pitch
             + x * bpp;
@@ -9,6 +9,36 @@
 #include "SurfaceTool.h"
 
 #include "SDLException.h"
+#include "SurfaceLock.h"
+#include "PixelTool.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
+#include "minmax.h"
+
+#include <string.h>
+
+namespace {
+/**
+ * Copy rows of the whole surface.
+ */
+class CopyRows : public RowTask {
+    private:
+        SDL_Surface *m_src;
+        SDL_Surface *m_dest;
+        int m_x;
+        int m_y;
+    public:
+        CopyRows(SDL_Surface *src, SDL_Surface *dest, int x, int y)
+            : m_src(src), m_dest(dest), m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            for (int py = begin; py < end; ++py) {
+                SurfaceTool::copySpan(m_src, 0, py,
+                        m_dest, m_x, m_y + py, m_src->w);
+            }
+        }
+};
+}
 
 //-----------------------------------------------------------------
 /**
@@ -104,3 +134,128 @@ SurfaceTool::alphaFill(SDL_Surface *surface, SDL_Rect *dstrect,
     SDL_FreeSurface(canvas);
 }
 
+//-----------------------------------------------------------------
+/**
+ * Compose surface over a layer with alpha channel.
+ * Unlike SDL_BlitSurface, the layer alpha is updated too,
+ * so the layer can be later blitted over anything else.
+ * Pixels outside the layer clip rect are skipped.
+ *
+ * @param layer destination with alpha channel
+ * @param surface source with alpha channel or colorkey
+ * @param x destination x
+ * @param y destination y
+ */
+    void
+SurfaceTool::blitOver(SDL_Surface *layer, SDL_Surface *surface,
+        int x, int y)
+{
+    SurfaceLock lock1(layer);
+    SurfaceLock lock2(surface);
+
+    const SDL_Rect &clip = layer->clip_rect;
+    bool colorKey = (surface->flags & SDL_SRCCOLORKEY);
+    for (int py = 0; py < surface->h; ++py) {
+        if (y + py < clip.y || y + py >= clip.y + clip.h) {
+            continue;
+        }
+        for (int px = 0; px < surface->w; ++px) {
+            if (x + px < clip.x || x + px >= clip.x + clip.w) {
+                continue;
+            }
+            if (colorKey && PixelTool::getPixel(surface, px, py)
+                    == surface->format->colorkey)
+            {
+                continue;
+            }
+
+            SDL_Color pixel = PixelTool::getColor(surface, px, py);
+            if (pixel.unused < 255 && pixel.unused > 0) {
+                SDL_Color under = PixelTool::getColor(layer, x + px, y + py);
+                int srcA = pixel.unused;
+                int dstA = under.unused * (255 - srcA) / 255;
+                int outA = srcA + dstA;
+                pixel.r = (pixel.r * srcA + under.r * dstA) / outA;
+                pixel.g = (pixel.g * srcA + under.g * dstA) / outA;
+                pixel.b = (pixel.b * srcA + under.b * dstA) / outA;
+                pixel.unused = outA;
+            }
+            if (pixel.unused > 0) {
+                PixelTool::putColor(layer, x + px, y + py, pixel);
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Whether pixels can be copied without conversion and blending.
+ */
+    bool
+SurfaceTool::isRawCopy(SDL_Surface *src, SDL_Surface *dest)
+{
+    return !(src->flags & (SDL_SRCALPHA | SDL_SRCCOLORKEY))
+        && src->format->BytesPerPixel == dest->format->BytesPerPixel
+        && src->format->Rmask == dest->format->Rmask
+        && src->format->Gmask == dest->format->Gmask
+        && src->format->Bmask == dest->format->Bmask
+        && src->format->Amask == dest->format->Amask;
+}
+//-----------------------------------------------------------------
+/**
+ * Copy a span of one row.
+ * The span is clipped by both surfaces and by the dest clip rect.
+ * Surfaces must be locked and raw copy must be possible.
+ */
+    void
+SurfaceTool::copySpan(SDL_Surface *src, int srcX, int srcY,
+        SDL_Surface *dest, int destX, int destY, int w)
+{
+    const SDL_Rect &clip = dest->clip_rect;
+    if (srcY < 0 || srcY >= src->h
+            || destY < clip.y || destY >= clip.y + clip.h) {
+        return;
+    }
+    if (srcX < 0) {
+        destX -= srcX;
+        w += srcX;
+        srcX = 0;
+    }
+    if (destX < clip.x) {
+        srcX += clip.x - destX;
+        w -= clip.x - destX;
+        destX = clip.x;
+    }
+    w = min(w, src->w - srcX);
+    w = min(w, clip.x + clip.w - destX);
+    if (w <= 0) {
+        return;
+    }
+
+    int bpp = src->format->BytesPerPixel;
+    memcpy(static_cast<Uint8*>(dest->pixels)
+            + destY * dest->pitch + destX * bpp,
+            static_cast<Uint8*>(src->pixels)
+            + srcY * src->pitch + srcX * bpp,
+            w * bpp);
+}
+//-----------------------------------------------------------------
+/**
+ * Blit whole surface to [x,y].
+ * Large opaque copies are split among workers.
+ */
+    void
+SurfaceTool::blitCopy(SDL_Surface *src, SDL_Surface *dest, int x, int y)
+{
+    if (isRawCopy(src, dest)) {
+        SurfaceLock lock1(dest);
+        SurfaceLock lock2(src);
+        CopyRows task(src, dest, x, y);
+        WorkerPool::forRows(&task, src->h, src->w * src->h);
+    }
+    else {
+        SDL_Rect dest_rect;
+        dest_rect.x = x;
+        dest_rect.y = y;
+        SDL_BlitSurface(src, NULL, dest, &dest_rect);
+    }
+}
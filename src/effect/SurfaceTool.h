@@ -15,6 +15,13 @@ class SurfaceTool {
         static SDL_Surface *createClone(SDL_Surface *surface);
         static void alphaFill(SDL_Surface *surface, SDL_Rect *dstrect,
                 const SDL_Color &color);
+        static void blitOver(SDL_Surface *layer, SDL_Surface *surface,
+                int x, int y);
+        static bool isRawCopy(SDL_Surface *src, SDL_Surface *dest);
+        static void copySpan(SDL_Surface *src, int srcX, int srcY,
+                SDL_Surface *dest, int destX, int destY, int w);
+        static void blitCopy(SDL_Surface *src, SDL_Surface *dest,
+                int x, int y);
 };
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "TextCache.h"
+
+//-----------------------------------------------------------------
+/**
+ * Create cache for the given number of rendered texts.
+ */
+TextCache::TextCache(unsigned int capacity)
+{
+    m_capacity = capacity;
+    m_hits = 0;
+    m_misses = 0;
+}
+//-----------------------------------------------------------------
+TextCache::~TextCache()
+{
+    removeAll();
+}
+//-----------------------------------------------------------------
+/**
+ * Return cached surface or NULL.
+ * The found entry becomes the most recently used one.
+ * @return new reference to the shared surface, free it after use
+ */
+SDL_Surface *
+TextCache::get(const std::string &key)
+{
+    t_index::iterator it = m_index.find(key);
+    if (m_index.end() == it) {
+        m_misses++;
+        return NULL;
+    }
+
+    m_hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    SDL_Surface *surface = it->second->second;
+    surface->refcount++;
+    return surface;
+}
+//-----------------------------------------------------------------
+/**
+ * Remember rendered surface.
+ * The cache takes own reference, the caller keeps his one.
+ * The least recently used entry is dropped when cache is full.
+ */
+void
+TextCache::put(const std::string &key, SDL_Surface *surface)
+{
+    if (m_index.find(key) != m_index.end() || 0 == m_capacity) {
+        return;
+    }
+
+    while (m_entries.size() >= m_capacity) {
+        SDL_FreeSurface(m_entries.back().second);
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+
+    surface->refcount++;
+    m_entries.push_front(t_entry(key, surface));
+    m_index[key] = m_entries.begin();
+}
+//-----------------------------------------------------------------
+/**
+ * Release all cached surfaces.
+ * Surfaces still used by others remain valid.
+ */
+void
+TextCache::removeAll()
+{
+    t_entries::iterator end = m_entries.end();
+    for (t_entries::iterator i = m_entries.begin(); i != end; ++i) {
+        SDL_FreeSurface(i->second);
+    }
+    m_entries.clear();
+    m_index.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef HEADER_TEXTCACHE_H
+#define HEADER_TEXTCACHE_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <list>
+#include <map>
+
+/**
+ * Bounded LRU cache of rendered texts.
+ * Surfaces are shared through SDL refcount,
+ * the user frees his copy with SDL_FreeSurface as usual.
+ */
+class TextCache : public NoCopy {
+    private:
+        typedef std::pair<std::string,SDL_Surface*> t_entry;
+        typedef std::list<t_entry> t_entries;
+        typedef std::map<std::string,t_entries::iterator> t_index;
+        t_entries m_entries;
+        t_index m_index;
+        unsigned int m_capacity;
+        long m_hits;
+        long m_misses;
+    public:
+        explicit TextCache(unsigned int capacity);
+        virtual ~TextCache();
+
+        SDL_Surface *get(const std::string &key);
+        void put(const std::string &key, SDL_Surface *surface);
+        void removeAll();
+
+        long getHits() const { return m_hits; }
+        long getMisses() const { return m_misses; }
+};
+
+#endif
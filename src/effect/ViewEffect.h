@@ -16,8 +16,24 @@ class ViewEffect {
         virtual const char* getName() const = 0;
         virtual bool isDisintegrated() const { return false; }
         virtual bool isInvisible() const { return false; }
+        /**
+         * Whether the result depends only on the surface.
+         * Static effects can be cached in a layer.
+         */
+        virtual bool isStatic() const { return false; }
+        /**
+         * Whether a trimmed surface can be blitted at shifted position.
+         * Other effects get the whole untrimmed surface.
+         */
+        virtual bool canTrim() const { return false; }
         virtual void blit(SDL_Surface *screen, SDL_Surface *surface,
                 int x, int y) = 0;
+        /**
+         * Blit onto a transparent layer, the layer alpha is kept valid.
+         * Effects writing only opaque pixels can use plain blit.
+         */
+        virtual void blitOver(SDL_Surface *layer, SDL_Surface *surface,
+                int x, int y) { blit(layer, surface, x, y); }
 };
 
 #endif
@@ -9,9 +9,55 @@
 #include "WavyPicture.h"
 
 #include "TimerAgent.h"
+#include "SurfaceTool.h"
+#include "SurfaceLock.h"
+#include "RowTask.h"
+#include "WorkerPool.h"
 
 #include <math.h>
 
+namespace {
+/**
+ * Shift rows of an opaque picture.
+ * The same waves as the blit loop in WavyPicture::drawOn.
+ */
+class WavyRows : public RowTask {
+    private:
+        SDL_Surface *m_surface;
+        SDL_Surface *m_screen;
+        int m_x;
+        int m_y;
+        float m_amp;
+        float m_periode;
+        float m_shift;
+    public:
+        WavyRows(SDL_Surface *surface, SDL_Surface *screen, int x, int y,
+                float amp, float periode, float shift)
+            : m_surface(surface), m_screen(screen), m_x(x), m_y(y),
+            m_amp(amp), m_periode(periode), m_shift(shift) {}
+        virtual void runRows(int begin, int end)
+        {
+            int w = m_surface->w;
+            for (int py = begin; py < end; ++py) {
+                int shiftX = static_cast<Sint16>(0.5 +
+                        m_amp * sin(py / m_periode + m_shift));
+                if (shiftX >= 0) {
+                    SurfaceTool::copySpan(m_surface, shiftX, py,
+                            m_screen, m_x, m_y + py, w - shiftX);
+                    SurfaceTool::copySpan(m_surface, w - shiftX, py,
+                            m_screen, m_x + w - shiftX, m_y + py, shiftX);
+                }
+                else {
+                    SurfaceTool::copySpan(m_surface, 0, py,
+                            m_screen, m_x - shiftX, m_y + py, w + shiftX);
+                    SurfaceTool::copySpan(m_surface, 0, py,
+                            m_screen, m_x, m_y + py, -shiftX);
+                }
+            }
+        }
+};
+}
+
 //-----------------------------------------------------------------
 /**
  * Load surface.
@@ -46,7 +92,16 @@ WavyPicture::drawOn(SDL_Surface *screen)
     SDL_Rect pad;
     pad.h = 1;
 
-    float shift = TimerAgent::agent()->getCycles() * m_speed;
+    float shift = TimerAgent::agent()->getSmoothCycles() * m_speed;
+    if (SurfaceTool::isRawCopy(m_surface, screen)) {
+        SurfaceLock lock1(screen);
+        SurfaceLock lock2(m_surface);
+        WavyRows task(m_surface, screen, m_loc.getX(), m_loc.getY(),
+                m_amp, m_periode, shift);
+        WorkerPool::forRows(&task, m_surface->h,
+                m_surface->w * m_surface->h);
+        return;
+    }
 
     for (int py = 0; py < m_surface->h; ++py) {
         //NOTE: C99 has lrintf and sinf
@@ -16,6 +16,7 @@ class WavyPicture : public Picture {
         void setWamp(float amplitude) { m_amp = amplitude; }
         void setWperiode(float periode) { m_periode = periode; }
         void setWspeed(float speed) { m_speed = speed; }
+        bool isWavy() const { return m_amp != 0; }
 
         virtual void drawOn(SDL_Surface *screen);
 };
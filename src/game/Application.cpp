@@ -28,7 +28,13 @@
 #include "Font.h"
 
 #include "SimpleMsg.h"
+#include "ResImagePack.h"
+#include "ResSoundPack.h"
+#include "AssetPack.h"
+#include "DataIndex.h"
+#include "SolvedIndex.h"
 #include "StringMsg.h"
+#include "ScriptState.h"
 
 #include "SDL.h"
 #include <stdio.h> // for fflush, stdout
@@ -59,6 +65,12 @@ Application::Application()
 Application::~Application()
 {
     delete m_agents;
+    ResImagePack::logCacheStats();
+    ResSoundPack::logCacheStats();
+    ScriptState::logGcStats();
+    AssetPack::shutdown();
+    SolvedIndex::shutdown();
+    DataIndex::shutdown();
     Font::shutdown();
 }
 //-----------------------------------------------------------------
@@ -132,8 +144,58 @@ Application::prepareOptions(int argc, char *argv[])
             "Music volume in percentage");
     params.addParam("worldmap", OptionParams::TYPE_STRING,
             "Path to the worldmap file");
+    params.addParam("path_index", OptionParams::TYPE_BOOLEAN,
+            "Find data files in memory index (default=true)");
+    params.addParam("cache_scripts", OptionParams::TYPE_BOOLEAN,
+            "Cache compiled scripts in userdir (default=true)");
+    params.addParam("profile_scripts", OptionParams::TYPE_BOOLEAN,
+            "Profile level scripts, F8 shows the profile (default=false)");
+    params.addParam("script_gc", OptionParams::TYPE_BOOLEAN,
+            "Collect script garbage in idle frame time (default=true)");
+    params.addParam("export_solutions", OptionParams::TYPE_BOOLEAN,
+            "Export solutions to solved/<codename>.lua files (default=false)");
     params.addParam("cache_images", OptionParams::TYPE_BOOLEAN,
             "Cache images (default=true)");
+    params.addParam("asset_pack", OptionParams::TYPE_BOOLEAN,
+            "Use pre-decoded images and sounds from assets.pak (default=true)");
+    params.addParam("prefetch_images", OptionParams::TYPE_BOOLEAN,
+            "Decode next level images on background (default=true)");
+    params.addParam("static_layer", OptionParams::TYPE_BOOLEAN,
+            "Cache non-moving objects with background (default=true)");
+    params.addParam("pack_images", OptionParams::TYPE_BOOLEAN,
+            "Pack level sprites into a few large surfaces (default=true)");
+    params.addParam("benchmark", OptionParams::TYPE_BOOLEAN,
+            "Run without delays on a virtual clock (default=false)");
+    params.addParam("frameinterval", OptionParams::TYPE_NUMBER,
+            "Time between drawn frames, 0 draws once per tick (default=16)");
+    params.addParam("offscreen", OptionParams::TYPE_BOOLEAN,
+            "Draw without a window (default=false)");
+    params.addParam("dump_frame", OptionParams::TYPE_NUMBER,
+            "Save the Nth drawn frame (default=0)");
+    params.addParam("dump_every", OptionParams::TYPE_NUMBER,
+            "Save every Kth drawn frame (default=0)");
+    params.addParam("dump_prefix", OptionParams::TYPE_STRING,
+            "File prefix for saved frames (default=frame)");
+    params.addParam("dump_format", OptionParams::TYPE_STRING,
+            "Format of saved frames, ppm or bmp (default=ppm)");
+    params.addParam("capture", OptionParams::TYPE_STRING,
+            "Capture all frames to this file or file prefix");
+    params.addParam("capture_format", OptionParams::TYPE_STRING,
+            "Capture format, ppm, raw or y4m (default=ppm)");
+    params.addParam("capture_fps", OptionParams::TYPE_NUMBER,
+            "Frame rate in y4m header (default=1000/timeinterval)");
+    params.addParam("fixed_screen", OptionParams::TYPE_BOOLEAN,
+            "Keep one video mode, center rooms on it (default=false)");
+    params.addParam("fixed_width", OptionParams::TYPE_NUMBER,
+            "Width of the fixed video mode (default=1024)");
+    params.addParam("fixed_height", OptionParams::TYPE_NUMBER,
+            "Height of the fixed video mode (default=768)");
+    params.addParam("fixed_scale", OptionParams::TYPE_BOOLEAN,
+            "Use integer scaling in the fixed video mode (default=true)");
+    params.addParam("stream_music", OptionParams::TYPE_BOOLEAN,
+            "Decode looping music on background (default=true)");
+    params.addParam("worker_threads", OptionParams::TYPE_NUMBER,
+            "Threads for full-screen drawing (default=cpus-1)");
     params.addParam("sound_frequency", OptionParams::TYPE_NUMBER,
             "Sound sample rate (default=44100)");
     params.addParam("strict_rules", OptionParams::TYPE_BOOLEAN,
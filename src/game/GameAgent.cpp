@@ -19,6 +19,7 @@
 #include "IntMsg.h"
 #include "Path.h"
 #include "OptionAgent.h"
+#include "TimerAgent.h"
 #include "LevelStatus.h"
 #include "Level.h"
 
@@ -77,7 +78,9 @@ GameAgent::replaySolution(const std::string &codename)
     void
 GameAgent::own_update()
 {
-    m_manager->updateGame();
+    if (TimerAgent::agent()->isTick()) {
+        m_manager->updateGame();
+    }
 }
 //-----------------------------------------------------------------
 /**
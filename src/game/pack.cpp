@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+/**
+ * Offline packer for assets.pak.
+ * Usage: fillets-pack <systemdir> [sound_frequency]
+ *
+ * Images from "images/" are decoded to 32bit ARGB,
+ * sounds from "sound/" to PCM in the default mixer format.
+ * The game uses the archive instead of decoding loose files.
+ */
+#include "AssetPack.h"
+#include "ResImagePack.h"
+#include "BaseException.h"
+#include "FsPath.h"
+
+#include "SDL.h"
+#include "SDL_image.h"
+#include "SDL_mixer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+//-----------------------------------------------------------------
+bool
+hasSuffix(const std::string &name, const char *suffix)
+{
+    std::string::size_type length = strlen(suffix);
+    return name.size() > length
+        && name.compare(name.size() - length, length, suffix) == 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Collect files with the given suffixes under dir.
+ * @param root systemdir
+ * @param dir directory relative to root
+ */
+void
+listFiles(const std::string &root, const std::string &dir,
+        const char *suffixA, const char *suffixB,
+        std::vector<std::string> *files)
+{
+    DIR *handle = opendir(FsPath::join(root, dir).c_str());
+    if (NULL == handle) {
+        return;
+    }
+    struct dirent *item;
+    while ((item = readdir(handle)) != NULL) {
+        std::string name = item->d_name;
+        if (name.empty() || name[0] == '.') {
+            continue;
+        }
+        std::string file = dir + "/" + name;
+        struct stat info;
+        if (stat(FsPath::join(root, file).c_str(), &info) != 0) {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            listFiles(root, file, suffixA, suffixB, files);
+        }
+        else if (hasSuffix(name, suffixA)
+                || (suffixB && hasSuffix(name, suffixB))) {
+            files->push_back(file);
+        }
+    }
+    closedir(handle);
+}
+//-----------------------------------------------------------------
+/**
+ * Whether current file end is addressable by 32bit entry offsets.
+ */
+bool
+isAddressable(FILE *out)
+{
+    long offset = ftell(out);
+    return offset >= 0 && static_cast<unsigned long>(offset) <= 0xffffffffUL;
+}
+//-----------------------------------------------------------------
+/**
+ * Pad file to the archive alignment.
+ * @return new file offset
+ */
+Uint32
+alignFile(FILE *out)
+{
+    long offset = ftell(out);
+    while (offset % AssetPack::ALIGN) {
+        fputc(0, out);
+        offset++;
+    }
+    return offset;
+}
+//-----------------------------------------------------------------
+/**
+ * Decode image like ResImagePack does
+ * and write its pixels.
+ * @return false when image cannot be decoded
+ */
+bool
+writeImage(const std::string &path, AssetPack::Entry *entry, FILE *out)
+{
+    SDL_Surface *raw = IMG_Load(path.c_str());
+    if (NULL == raw) {
+        return false;
+    }
+    SDL_Surface *argb = SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, 32,
+            0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    SDL_Surface *surface = NULL;
+    if (argb) {
+        surface = SDL_ConvertSurface(raw, argb->format, SDL_SRCALPHA);
+        SDL_FreeSurface(argb);
+    }
+    SDL_FreeSurface(raw);
+    if (NULL == surface) {
+        return false;
+    }
+
+    SDL_Color key;
+    bool transparent = false;
+    bool keyed = false;
+    try {
+        keyed = ResImagePack::findColorKey(surface, &key, &transparent);
+    }
+    catch (BaseException &e) {
+        fprintf(stderr, "%s\n", e.what());
+    }
+    entry->flags = AssetPack::FLAG_ALPHA;
+    if (keyed) {
+        entry->flags = transparent ? AssetPack::FLAG_COLORKEY : 0;
+        entry->colorkey = (key.r << 16) | (key.g << 8) | key.b;
+    }
+
+    entry->w = surface->w;
+    entry->h = surface->h;
+    entry->offset = alignFile(out);
+    entry->length = surface->w * surface->h * 4;
+    std::vector<Uint32> row(surface->w);
+    for (int y = 0; y < surface->h; ++y) {
+        memcpy(&row[0], static_cast<Uint8*>(surface->pixels)
+                + y * surface->pitch, surface->w * 4);
+        if (keyed) {
+            for (int x = 0; x < surface->w; ++x) {
+                row[x] &= 0x00ffffff;
+            }
+        }
+        fwrite(&row[0], 4, surface->w, out);
+    }
+    SDL_FreeSurface(surface);
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Decode sound to mixer format and write its samples.
+ * @return false when sound cannot be decoded
+ */
+bool
+writeSound(const std::string &path, AssetPack::Entry *entry, FILE *out)
+{
+    Mix_Chunk *chunk = Mix_LoadWAV(path.c_str());
+    if (NULL == chunk) {
+        return false;
+    }
+    entry->offset = alignFile(out);
+    entry->length = chunk->alen;
+    fwrite(chunk->abuf, 1, chunk->alen, out);
+    Mix_FreeChunk(chunk);
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Write whole archive.
+ * Index is written first with empty entries
+ * and rewritten after all data are stored.
+ * @return false when writing fails or archive exceeds 4 GB
+ */
+bool
+writePack(const std::string &root, const std::vector<std::string> &files,
+        const std::vector<Uint32> &kinds, FILE *out)
+{
+    AssetPack::Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AssetPack::MAGIC;
+    header.version = AssetPack::VERSION;
+    header.count = files.size();
+    int frequency = 0;
+    Uint16 format = 0;
+    int channels = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    header.frequency = frequency;
+    header.format = format;
+    header.channels = channels;
+
+    std::vector<AssetPack::Entry> entries(files.size());
+    memset(&entries[0], 0, entries.size() * sizeof(AssetPack::Entry));
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(&entries[0], sizeof(AssetPack::Entry), entries.size(), out);
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        entries[i].name = ftell(out);
+        entries[i].nameLength = files[i].size();
+        fwrite(files[i].data(), 1, files[i].size(), out);
+    }
+    if (!isAddressable(out)) {
+        fprintf(stderr, "too many files\n");
+        return false;
+    }
+
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        std::string path = FsPath::join(root, files[i]);
+        AssetPack::Entry &entry = entries[i];
+        entry.kind = kinds[i];
+        AssetPack::statFile(path, &entry.mtime, &entry.size);
+        bool written = (kinds[i] == AssetPack::KIND_IMAGE) ?
+            writeImage(path, &entry, out) : writeSound(path, &entry, out);
+        if (!written) {
+            fprintf(stderr, "cannot decode: %s\n", path.c_str());
+            entry.kind = 0;
+        }
+        if (!isAddressable(out)) {
+            fprintf(stderr, "archive exceeds 4 GB at: %s\n", path.c_str());
+            return false;
+        }
+    }
+
+    fseek(out, sizeof(header), SEEK_SET);
+    fwrite(&entries[0], sizeof(AssetPack::Entry), entries.size(), out);
+    return !ferror(out);
+}
+
+}
+
+//-----------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <systemdir> [sound_frequency]\n",
+                argv[0]);
+        return 1;
+    }
+    std::string root = argv[1];
+    int frequency = argc > 2 ? atoi(argv[2]) : 44100;
+
+    SDL_putenv(const_cast<char*>("SDL_AUDIODRIVER=dummy"));
+    if (SDL_Init(SDL_INIT_AUDIO) < 0
+            || Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
+        fprintf(stderr, "cannot open audio: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::vector<std::string> images;
+    std::vector<std::string> sounds;
+    listFiles(root, "images", ".png", NULL, &images);
+    listFiles(root, "sound", ".ogg", ".wav", &sounds);
+    std::sort(images.begin(), images.end());
+    std::sort(sounds.begin(), sounds.end());
+
+    std::vector<std::string> files(images);
+    std::vector<Uint32> kinds(images.size(), AssetPack::KIND_IMAGE);
+    files.insert(files.end(), sounds.begin(), sounds.end());
+    kinds.insert(kinds.end(), sounds.size(), AssetPack::KIND_SOUND);
+
+    if (files.empty()) {
+        fprintf(stderr, "no images or sounds in: %s\n", root.c_str());
+        Mix_CloseAudio();
+        SDL_Quit();
+        return 1;
+    }
+
+    std::string packname = FsPath::join(root, "assets.pak");
+    std::string tmpname = packname + ".tmp";
+    FILE *out = fopen(tmpname.c_str(), "wb");
+    bool ok = out && writePack(root, files, kinds, out);
+    if (out) {
+        ok = (0 == fclose(out)) && ok;
+    }
+    if (ok) {
+        remove(packname.c_str());
+        ok = (0 == rename(tmpname.c_str(), packname.c_str()));
+    }
+
+    Mix_CloseAudio();
+    SDL_Quit();
+    if (!ok) {
+        fprintf(stderr, "cannot write: %s\n", packname.c_str());
+        remove(tmpname.c_str());
+        return 1;
+    }
+    printf("%s: %u images, %u sounds\n", packname.c_str(),
+            static_cast<unsigned int>(images.size()),
+            static_cast<unsigned int>(sounds.size()));
+    return 0;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "AssetPack.h"
+
+#include "Path.h"
+#include "FsPath.h"
+#include "Log.h"
+#include "OptionAgent.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+AssetPack *AssetPack::ms_pack = NULL;
+bool AssetPack::ms_opened = false;
+
+//-----------------------------------------------------------------
+AssetPack::AssetPack(Uint8 *data, Uint32 length)
+{
+    m_data = data;
+    m_length = length;
+    m_header = reinterpret_cast<const Header*>(m_data);
+}
+//-----------------------------------------------------------------
+/**
+ * Unmap archive.
+ * NOTE: surfaces and sounds from the archive must be freed before.
+ */
+AssetPack::~AssetPack()
+{
+#ifdef WIN32
+    free(m_data);
+#else
+    munmap(m_data, m_length);
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * Return shared archive or NULL.
+ * The "assets.pak" from systemdir is opened on first use
+ * unless "asset_pack" option is disabled.
+ */
+AssetPack *
+AssetPack::pack()
+{
+    if (!ms_opened) {
+        ms_opened = true;
+        if (OptionAgent::agent()->getAsBool("asset_pack", true)) {
+            std::string dir = OptionAgent::agent()->getParam("systemdir");
+            ms_pack = open(FsPath::join(dir, "assets.pak"));
+            if (ms_pack && !ms_pack->readIndex(dir)) {
+                delete ms_pack;
+                ms_pack = NULL;
+            }
+        }
+    }
+    return ms_pack;
+}
+//-----------------------------------------------------------------
+void
+AssetPack::shutdown()
+{
+    delete ms_pack;
+    ms_pack = NULL;
+    ms_opened = false;
+}
+//-----------------------------------------------------------------
+/**
+ * Map archive file to memory.
+ * Pages are private, so pixels can be modified by their users.
+ * @return archive or NULL when file cannot be mapped
+ */
+AssetPack *
+AssetPack::open(const std::string &file)
+{
+    std::string native = FsPath::getNative(file);
+    Uint8 *data = NULL;
+    Uint32 length = 0;
+#ifdef WIN32
+    FILE *packFile = fopen(native.c_str(), "rb");
+    if (NULL == packFile) {
+        return NULL;
+    }
+    fseek(packFile, 0, SEEK_END);
+    length = ftell(packFile);
+    fseek(packFile, 0, SEEK_SET);
+    data = static_cast<Uint8*>(malloc(length));
+    if (data && fread(data, 1, length, packFile) != length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(packFile);
+#else
+    int fd = ::open(native.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (0 == fstat(fd, &info) && info.st_size > 0) {
+        length = info.st_size;
+        void *mapped = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<Uint8*>(mapped);
+        }
+    }
+    close(fd);
+#endif
+
+    if (NULL == data) {
+        LOG_WARNING(ExInfo("cannot map asset pack")
+                .addInfo("file", native));
+        return NULL;
+    }
+    return new AssetPack(data, length);
+}
+//-----------------------------------------------------------------
+/**
+ * Check header and index entries by their system paths.
+ * Freshness is checked here once,
+ * entries older than their loose files are left out.
+ * @return false for unknown or corrupted archive
+ */
+bool
+AssetPack::readIndex(const std::string &dir)
+{
+    if (m_length < sizeof(Header) || m_header->magic != MAGIC
+            || m_header->version != VERSION
+            || m_header->count > (m_length - sizeof(Header)) / sizeof(Entry))
+    {
+        LOG_WARNING(ExInfo("unknown asset pack version"));
+        return false;
+    }
+
+    int stale = 0;
+    const Entry *entries = reinterpret_cast<const Entry*>(m_header + 1);
+    for (Uint32 i = 0; i < m_header->count; ++i) {
+        const Entry &entry = entries[i];
+        if (entry.name > m_length || entry.nameLength > m_length - entry.name
+                || entry.offset > m_length
+                || entry.length > m_length - entry.offset)
+        {
+            LOG_WARNING(ExInfo("corrupted asset pack"));
+            return false;
+        }
+        std::string name(reinterpret_cast<const char*>(m_data + entry.name),
+                entry.nameLength);
+        std::string file = FsPath::join(dir, name);
+        if (isFresh(file, entry)) {
+            m_entries[file] = &entry;
+        }
+        else {
+            stale++;
+        }
+    }
+    LOG_INFO(ExInfo("asset pack")
+            .addInfo("entries", m_header->count)
+            .addInfo("stale", stale)
+            .addInfo("bytes", m_length));
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Read modification time and size of a file.
+ * @return false when file does not exist
+ */
+bool
+AssetPack::statFile(const std::string &file, Uint32 *mtime, Uint32 *size)
+{
+    struct stat info;
+    if (stat(FsPath::getNative(file).c_str(), &info) != 0) {
+        return false;
+    }
+    *mtime = info.st_mtime;
+    *size = info.st_size;
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Return false when an existing loose file differs from the entry.
+ */
+bool
+AssetPack::isFresh(const std::string &file, const Entry &entry)
+{
+    Uint32 mtime;
+    Uint32 size;
+    if (statFile(file, &mtime, &size)
+            && (mtime != entry.mtime || size != entry.size)) {
+        LOG_DEBUG(ExInfo("stale asset pack entry")
+                .addInfo("file", file));
+        return false;
+    }
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Find entry for the given file.
+ */
+const AssetPack::Entry *
+AssetPack::findEntry(const std::string &file, Uint32 kind) const
+{
+    t_entries::const_iterator it = m_entries.find(file);
+    if (it == m_entries.end() || it->second->kind != kind) {
+        return NULL;
+    }
+    return it->second;
+}
+//-----------------------------------------------------------------
+/**
+ * Return true when the file is in the archive.
+ */
+bool
+AssetPack::isPacked(const std::string &file)
+{
+    AssetPack *assets = pack();
+    return assets && assets->m_entries.find(file) != assets->m_entries.end();
+}
+//-----------------------------------------------------------------
+/**
+ * Create displayformat surface over archived pixels.
+ * Only screens with 32bit RGB are supported,
+ * loose files are used otherwise.
+ *
+ * @return surface without own pixels or NULL
+ */
+SDL_Surface *
+AssetPack::loadImage(const Path &file)
+{
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    AssetPack *assets = pack();
+    if (NULL == assets || NULL == screen
+            || screen->format->BytesPerPixel != 4
+            || screen->format->Rmask != 0x00ff0000
+            || screen->format->Gmask != 0x0000ff00
+            || screen->format->Bmask != 0x000000ff)
+    {
+        return NULL;
+    }
+
+    const Entry *entry = assets->findEntry(file.getPosixName(), KIND_IMAGE);
+    if (NULL == entry || entry->length != entry->w * entry->h * 4) {
+        return NULL;
+    }
+
+    Uint32 amask = (entry->flags & FLAG_ALPHA) ? 0xff000000 : 0;
+    SDL_Surface *surface = SDL_CreateRGBSurfaceFrom(
+            assets->m_data + entry->offset, entry->w, entry->h, 32,
+            entry->w * 4, 0x00ff0000, 0x0000ff00, 0x000000ff, amask);
+    if (NULL == surface) {
+        return NULL;
+    }
+    if (entry->flags & FLAG_COLORKEY) {
+        SDL_SetColorKey(surface, SDL_SRCCOLORKEY | SDL_RLEACCEL,
+                entry->colorkey);
+    }
+    return surface;
+}
+//-----------------------------------------------------------------
+/**
+ * Create sound over archived samples.
+ * The mixer must use the same format as the packer.
+ *
+ * @return chunk without own samples or NULL
+ */
+Mix_Chunk *
+AssetPack::loadSound(const Path &file)
+{
+    AssetPack *assets = pack();
+    int frequency;
+    Uint16 format;
+    int channels;
+    if (NULL == assets || !Mix_QuerySpec(&frequency, &format, &channels)
+            || static_cast<Uint32>(frequency) != assets->m_header->frequency
+            || format != assets->m_header->format
+            || static_cast<Uint32>(channels) != assets->m_header->channels)
+    {
+        return NULL;
+    }
+
+    const Entry *entry = assets->findEntry(file.getPosixName(), KIND_SOUND);
+    if (NULL == entry) {
+        return NULL;
+    }
+    return Mix_QuickLoad_RAW(assets->m_data + entry->offset, entry->length);
+}
@@ -0,0 +1,81 @@
+#ifndef HEADER_ASSETPACK_H
+#define HEADER_ASSETPACK_H
+
+class Path;
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+#include "SDL_mixer.h"
+
+#include <string>
+#include <map>
+
+/**
+ * Archive with pre-decoded images and sounds.
+ * Images are stored as 32bit ARGB pixels,
+ * sounds as PCM in the mixer format used by the packer.
+ * The archive is mapped to memory and surfaces point directly to it.
+ */
+class AssetPack : public NoCopy {
+    public:
+        static const Uint32 MAGIC = 0x4b415046;
+        static const Uint32 VERSION = 1;
+        static const Uint32 ALIGN = 16;
+        enum eKind {
+            KIND_IMAGE = 1,
+            KIND_SOUND = 2
+        };
+        enum eFlag {
+            FLAG_ALPHA = 1,
+            FLAG_COLORKEY = 2
+        };
+        struct Header {
+            Uint32 magic;
+            Uint32 version;
+            Uint32 count;
+            Uint32 frequency;
+            Uint32 format;
+            Uint32 channels;
+        };
+        /** Offsets are from the start of the archive. */
+        struct Entry {
+            Uint32 name;
+            Uint32 nameLength;
+            Uint32 kind;
+            Uint32 flags;
+            Uint32 w;
+            Uint32 h;
+            Uint32 colorkey;
+            Uint32 offset;
+            Uint32 length;
+            Uint32 mtime;
+            Uint32 size;
+        };
+    private:
+        static AssetPack *ms_pack;
+        static bool ms_opened;
+        Uint8 *m_data;
+        Uint32 m_length;
+        const Header *m_header;
+        typedef std::map<std::string,const Entry*> t_entries;
+        t_entries m_entries;
+    private:
+        AssetPack(Uint8 *data, Uint32 length);
+        static AssetPack *pack();
+        static AssetPack *open(const std::string &file);
+        bool readIndex(const std::string &dir);
+        static bool isFresh(const std::string &file, const Entry &entry);
+        const Entry *findEntry(const std::string &file, Uint32 kind) const;
+    public:
+        ~AssetPack();
+        static void shutdown();
+        static bool statFile(const std::string &file,
+                Uint32 *mtime, Uint32 *size);
+
+        static bool isPacked(const std::string &file);
+        static SDL_Surface *loadImage(const Path &file);
+        static Mix_Chunk *loadSound(const Path &file);
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ConfigWriter.h"
+
+#include "Log.h"
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------
+ConfigWriter::ConfigWriter()
+{
+    m_thread = NULL;
+    m_failed = false;
+}
+//-----------------------------------------------------------------
+ConfigWriter::~ConfigWriter()
+{
+    wait();
+}
+//-----------------------------------------------------------------
+/**
+ * Start background write.
+ * Previous write is finished first.
+ * The file is written directly when no thread can be started.
+ */
+void
+ConfigWriter::write(const std::string &file, const std::string &text)
+{
+    wait();
+    m_file = file;
+    m_text = text;
+    m_thread = SDL_CreateThread(writerMain, this);
+    if (NULL == m_thread) {
+        m_failed = !writeFile(m_file, m_text);
+        wait();
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Wait for running write.
+ */
+void
+ConfigWriter::wait()
+{
+    if (m_thread) {
+        SDL_WaitThread(m_thread, NULL);
+        m_thread = NULL;
+    }
+    if (m_failed) {
+        m_failed = false;
+        LOG_WARNING(ExInfo("cannot save config")
+                .addInfo("file", m_file));
+    }
+}
+//-----------------------------------------------------------------
+int
+ConfigWriter::writerMain(void *data)
+{
+    ConfigWriter *writer = static_cast<ConfigWriter*>(data);
+    writer->m_failed = !writeFile(writer->m_file, writer->m_text);
+    return 0;
+}
+//-----------------------------------------------------------------
+bool
+ConfigWriter::writeFile(const std::string &file, const std::string &text)
+{
+    std::string temp = file + ".tmp";
+    FILE *config = fopen(temp.c_str(), "w");
+    if (NULL == config) {
+        return false;
+    }
+    bool result = fwrite(text.data(), 1, text.size(), config) == text.size();
+    result = (0 == fclose(config)) && result;
+#ifdef WIN32
+    if (result) {
+        remove(file.c_str());
+    }
+#endif
+    result = result && 0 == rename(temp.c_str(), file.c_str());
+    if (!result) {
+        remove(temp.c_str());
+    }
+    return result;
+}
@@ -0,0 +1,33 @@
+#ifndef HEADER_CONFIGWRITER_H
+#define HEADER_CONFIGWRITER_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+
+/**
+ * Writes config file on background.
+ * Only one write runs at a time,
+ * the file is replaced by rename of a complete temp file.
+ */
+class ConfigWriter : public NoCopy {
+    private:
+        SDL_Thread *m_thread;
+        std::string m_file;
+        std::string m_text;
+        bool m_failed;
+    private:
+        static int writerMain(void *data);
+        static bool writeFile(const std::string &file,
+                const std::string &text);
+    public:
+        ConfigWriter();
+        ~ConfigWriter();
+
+        void write(const std::string &file, const std::string &text);
+        void wait();
+};
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "DataIndex.h"
+
+#include "FsPath.h"
+#include "Log.h"
+#include "OptionAgent.h"
+
+#include <vector>
+
+DataIndex *DataIndex::ms_index = NULL;
+
+//-----------------------------------------------------------------
+/**
+ * Read both data dirs recursively.
+ */
+DataIndex::DataIndex(const std::string &systemdir,
+        const std::string &userdir)
+    : m_systemdir(systemdir), m_userdir(userdir)
+{
+    addTree(m_systemdir);
+    addTree(m_userdir);
+    LOG_INFO(ExInfo("data index")
+            .addInfo("entries", m_entries.size()));
+}
+//-----------------------------------------------------------------
+void
+DataIndex::shutdown()
+{
+    delete ms_index;
+    ms_index = NULL;
+}
+//-----------------------------------------------------------------
+/**
+ * Return index for current data dirs or NULL.
+ * Index is rebuilt when userdir or systemdir change.
+ * It can be disabled by "path_index" option.
+ */
+DataIndex *
+DataIndex::index()
+{
+    OptionAgent *options = OptionAgent::agent();
+    if (!options->getAsBool("path_index", true)) {
+        return NULL;
+    }
+
+    std::string systemdir = options->getParam("systemdir");
+    std::string userdir = options->getParam("userdir");
+    if (ms_index && (ms_index->m_systemdir != systemdir
+                || ms_index->m_userdir != userdir)) {
+        shutdown();
+    }
+    if (NULL == ms_index) {
+        ms_index = new DataIndex(systemdir, userdir);
+    }
+    return ms_index;
+}
+//-----------------------------------------------------------------
+void
+DataIndex::addTree(const std::string &dir)
+{
+    if (dir.empty()) {
+        return;
+    }
+    m_entries.insert(dir);
+
+    std::vector<std::string> files;
+    std::vector<std::string> dirs;
+    FsPath::listDir(dir, &files, &dirs);
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        m_entries.insert(FsPath::join(dir, files[i]));
+    }
+    for (unsigned int i = 0; i < dirs.size(); ++i) {
+        addTree(FsPath::join(dir, dirs[i]));
+    }
+}
+//-----------------------------------------------------------------
+bool
+DataIndex::isUnder(const std::string &file, const std::string &dir)
+{
+    return !dir.empty() && file.size() > dir.size()
+        && file.compare(0, dir.size(), dir) == 0
+        && file[dir.size()] == '/';
+}
+//-----------------------------------------------------------------
+/**
+ * Return true when the file is inside data dirs.
+ */
+bool
+DataIndex::isIndexed(const std::string &file) const
+{
+    return isUnder(file, m_systemdir) || isUnder(file, m_userdir);
+}
+//-----------------------------------------------------------------
+/**
+ * Returns true when file or directory exists.
+ * @param file posix filename
+ */
+bool
+DataIndex::exists(const std::string &file)
+{
+    DataIndex *data = index();
+    if (data && data->isIndexed(file)) {
+        return data->m_entries.find(file) != data->m_entries.end();
+    }
+    return FsPath::exists(file);
+}
+//-----------------------------------------------------------------
+/**
+ * Note a new file and its parent dirs.
+ * @param file posix filename
+ */
+void
+DataIndex::noteFile(const std::string &file)
+{
+    if (NULL == ms_index) {
+        return;
+    }
+
+    std::string path = file;
+    while (ms_index->isIndexed(path)) {
+        ms_index->m_entries.insert(path);
+        std::string::size_type pos = path.rfind('/');
+        if (pos == std::string::npos) {
+            break;
+        }
+        path.erase(pos);
+    }
+}
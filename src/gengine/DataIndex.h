@@ -0,0 +1,33 @@
+#ifndef HEADER_DATAINDEX_H
+#define HEADER_DATAINDEX_H
+
+#include "NoCopy.h"
+
+#include <string>
+#include <set>
+
+/**
+ * In-memory list of files in userdir and systemdir.
+ * Existence of data files is answered without stat().
+ * Paths outside data dirs are checked on disk.
+ */
+class DataIndex : public NoCopy {
+    private:
+        static DataIndex *ms_index;
+        std::string m_systemdir;
+        std::string m_userdir;
+        typedef std::set<std::string> t_entries;
+        t_entries m_entries;
+    private:
+        DataIndex(const std::string &systemdir, const std::string &userdir);
+        static DataIndex *index();
+        void addTree(const std::string &dir);
+        bool isIndexed(const std::string &file) const;
+    public:
+        static bool isUnder(const std::string &file, const std::string &dir);
+        static void shutdown();
+        static bool exists(const std::string &file);
+        static void noteFile(const std::string &file);
+};
+
+#endif
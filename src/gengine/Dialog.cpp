@@ -29,8 +29,25 @@ Dialog::Dialog(const std::string &lang,
 //-----------------------------------------------------------------
 Dialog::~Dialog()
 {
-    if (m_sound) {
-        Mix_FreeChunk(m_sound);
+    ResSoundPack::releaseSpeech(m_sound);
+}
+//-----------------------------------------------------------------
+/**
+ * Let sound be decoded on background before first talk.
+ */
+    void
+Dialog::prefetch() const
+{
+    if (NULL == m_sound && !m_soundfile.empty()) {
+        ResSoundPack::prefetchSpeech(Path::dataReadPath(m_soundfile));
+    }
+}
+//-----------------------------------------------------------------
+    void
+Dialog::cancelPrefetch() const
+{
+    if (NULL == m_sound && !m_soundfile.empty()) {
+        ResSoundPack::cancelSpeech(Path::dataReadPath(m_soundfile));
     }
 }
 //-----------------------------------------------------------------
@@ -47,7 +64,7 @@ Dialog::talk(int volume, int loops) const
 {
     if (NULL == m_sound && !m_soundfile.empty()) {
         Path soundPath = Path::dataReadPath(m_soundfile);
-        m_sound = ResSoundPack::loadSound(soundPath);
+        m_sound = ResSoundPack::getSpeech(soundPath);
     }
 
     int channel = SoundAgent::agent()->playSound(m_sound, volume, loops);
@@ -10,6 +10,7 @@
 /**
  * Dialog with sound and subtitle.
  * Dialog is const class only sound is lazy loaded.
+ * Sound is shared via speech cache.
  */
 class Dialog: public NoCopy {
     public:
@@ -25,6 +26,8 @@ class Dialog: public NoCopy {
         virtual ~Dialog();
 
         bool isSpeechless() const { return m_soundfile.empty(); }
+        void prefetch() const;
+        void cancelPrefetch() const;
         int talk(int volume, int loops=0) const;
         virtual void runSubtitle(const StringTool::t_args &args) const;
         std::string getLang() const { return m_lang; }
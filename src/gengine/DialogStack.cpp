@@ -40,11 +40,21 @@ DialogStack::updateStack()
 //-----------------------------------------------------------------
 /**
  * Store new dialog.
+ * Sound of the dialog is decoded on background
+ * when it is the best speech for this name.
  */
     void
 DialogStack::addDialog(const std::string &name, Dialog *dialog)
 {
+    const Dialog *previous = m_dialogs->findDialogSpeech(name, false);
     m_dialogs->addRes(name, dialog);
+
+    if (m_dialogs->findDialogSpeech(name, false) == dialog) {
+        if (previous) {
+            previous->cancelPrefetch();
+        }
+        dialog->prefetch();
+    }
 }
 //-----------------------------------------------------------------
 /**
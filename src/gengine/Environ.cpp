@@ -37,14 +37,7 @@ Environ::store(const Path &file)
 {
     FILE *config = fopen(file.getNative().c_str(), "w");
     if (config) {
-        fputs("-- this file is automatically generated\n", config);
-
-        t_values::iterator end = m_values.end();
-        for (t_values::iterator i = m_values.begin(); i != end; ++i) {
-            fprintf(config, "setParam(\"%s\", \"%s\")\n",
-                    i->first.c_str(), i->second.c_str());
-        }
-
+        fputs(getConfig().c_str(), config);
         fclose(config);
     }
     else {
@@ -53,6 +46,20 @@ Environ::store(const Path &file)
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Return params as config script.
+ */
+    std::string
+Environ::getConfig() const
+{
+    std::string config = "-- this file is automatically generated\n";
+    t_values::const_iterator end = m_values.end();
+    for (t_values::const_iterator i = m_values.begin(); i != end; ++i) {
+        config += "setParam(\"" + i->first + "\", \"" + i->second + "\")\n";
+    }
+    return config;
+}
+//-----------------------------------------------------------------
 /**
  * Set param.
  * Notice watchers.
@@ -21,6 +21,7 @@ class Environ : public NoCopy {
     public:
         virtual ~Environ();
         void store(const Path &file);
+        std::string getConfig() const;
 
         void setParam(const std::string &name, const std::string &value);
         void setParam(const std::string &name, long value);
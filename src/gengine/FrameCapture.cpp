@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "FrameCapture.h"
+
+#include "FrameDump.h"
+#include "Log.h"
+#include "SDLException.h"
+
+#include <vector>
+
+//-----------------------------------------------------------------
+/**
+ * Start writer thread.
+ * @param path output file or prefix for image sequence
+ * @param format "ppm", "raw" or "y4m"
+ * @param fps frame rate stored in y4m header
+ * @throws SDLException when thread cannot be started
+ */
+FrameCapture::FrameCapture(const std::string &path,
+        const std::string &format, int fps)
+    : m_path(path), m_format(format)
+{
+    m_fps = fps > 0 ? fps : 10;
+    m_finished = false;
+    m_stream = NULL;
+    m_failed = false;
+    m_written = 0;
+    m_segment = 1;
+    m_width = 0;
+    m_height = 0;
+    if (m_format != "raw" && m_format != "y4m") {
+        m_format = "ppm";
+    }
+
+    m_mutex = SDL_CreateMutex();
+    m_notEmpty = SDL_CreateCond();
+    m_notFull = SDL_CreateCond();
+    if (NULL == m_mutex || NULL == m_notEmpty || NULL == m_notFull) {
+        throw SDLException(ExInfo("CreateMutex"));
+    }
+    m_thread = SDL_CreateThread(writerMain, this);
+    if (NULL == m_thread) {
+        throw SDLException(ExInfo("CreateThread"));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Write all queued frames and stop.
+ */
+FrameCapture::~FrameCapture()
+{
+    SDL_LockMutex(m_mutex);
+    m_finished = true;
+    SDL_CondSignal(m_notEmpty);
+    SDL_UnlockMutex(m_mutex);
+    SDL_WaitThread(m_thread, NULL);
+
+    if (m_stream) {
+        fclose(m_stream);
+    }
+    SDL_DestroyCond(m_notFull);
+    SDL_DestroyCond(m_notEmpty);
+    SDL_DestroyMutex(m_mutex);
+    LOG_INFO(ExInfo("captured frames")
+            .addInfo("frames", m_written)
+            .addInfo("path", m_path));
+}
+//-----------------------------------------------------------------
+/**
+ * Copy finished frame into the queue.
+ * Waits when the queue is full.
+ * @throws SDLException when frame cannot be copied
+ */
+void
+FrameCapture::pushFrame(SDL_Surface *screen)
+{
+    SDL_Surface *rgb = FrameDump::createRgb(screen);
+
+    SDL_LockMutex(m_mutex);
+    while (m_frames.size() >= QUEUE_SIZE) {
+        SDL_CondWait(m_notFull, m_mutex);
+    }
+    m_frames.push_back(rgb);
+    SDL_CondSignal(m_notEmpty);
+    SDL_UnlockMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+int
+FrameCapture::writerMain(void *capture)
+{
+    static_cast<FrameCapture*>(capture)->writeLoop();
+    return 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Write frames until finished and queue is empty.
+ */
+void
+FrameCapture::writeLoop()
+{
+    SDL_LockMutex(m_mutex);
+    while (true) {
+        while (m_frames.empty() && !m_finished) {
+            SDL_CondWait(m_notEmpty, m_mutex);
+        }
+        if (m_frames.empty()) {
+            break;
+        }
+        SDL_Surface *rgb = m_frames.front();
+        m_frames.pop_front();
+        SDL_CondSignal(m_notFull);
+        SDL_UnlockMutex(m_mutex);
+
+        writeFrame(rgb);
+        SDL_FreeSurface(rgb);
+        SDL_LockMutex(m_mutex);
+    }
+    SDL_UnlockMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Encode one frame.
+ * Stream formats start a new file for a different size.
+ */
+void
+FrameCapture::writeFrame(SDL_Surface *rgb)
+{
+    if (m_format == "ppm") {
+        char number[16];
+        sprintf(number, "%06d", m_written + 1);
+        std::string filename = m_path + "-" + number + ".ppm";
+        FILE *file = fopen(filename.c_str(), "wb");
+        if (NULL == file) {
+            LOG_WARNING(ExInfo("cannot write frame")
+                    .addInfo("file", filename));
+            return;
+        }
+        FrameDump::writePpm(rgb, file);
+        fclose(file);
+        m_written++;
+        return;
+    }
+
+    if (m_stream && (rgb->w != m_width || rgb->h != m_height)) {
+        fclose(m_stream);
+        m_stream = NULL;
+        m_segment++;
+    }
+    if (NULL == m_stream && !openStream(rgb)) {
+        return;
+    }
+
+    if (m_format == "y4m") {
+        writeY4m(rgb);
+    }
+    else {
+        for (int y = 0; y < rgb->h; ++y) {
+            fwrite(static_cast<Uint8*>(rgb->pixels) + y * rgb->pitch,
+                    3, rgb->w, m_stream);
+        }
+    }
+    m_written++;
+}
+//-----------------------------------------------------------------
+/**
+ * Return path for the current segment.
+ * The first segment uses the given path,
+ * next segments have number before extension.
+ */
+std::string
+FrameCapture::getStreamPath() const
+{
+    if (m_segment == 1) {
+        return m_path;
+    }
+
+    char number[16];
+    sprintf(number, "-%d", m_segment);
+    std::string::size_type dot = m_path.rfind('.');
+    std::string::size_type slash = m_path.find_last_of("/\\");
+    if (dot == std::string::npos
+            || (slash != std::string::npos && dot < slash)) {
+        return m_path + number;
+    }
+    return m_path.substr(0, dot) + number + m_path.substr(dot);
+}
+//-----------------------------------------------------------------
+/**
+ * Open output stream, the first frame sets its size.
+ */
+bool
+FrameCapture::openStream(SDL_Surface *rgb)
+{
+    if (m_failed) {
+        return false;
+    }
+    std::string path = getStreamPath();
+    m_stream = fopen(path.c_str(), "wb");
+    if (NULL == m_stream) {
+        LOG_WARNING(ExInfo("cannot open capture")
+                .addInfo("file", path));
+        m_failed = true;
+        return false;
+    }
+    if (m_segment > 1) {
+        LOG_INFO(ExInfo("capture continues with new frame size")
+                .addInfo("file", path)
+                .addInfo("width", rgb->w)
+                .addInfo("height", rgb->h));
+    }
+
+    m_width = rgb->w;
+    m_height = rgb->h;
+    if (m_format == "y4m") {
+        fprintf(m_stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+                m_width, m_height, m_fps);
+    }
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Convert to BT.601 YCbCr planes.
+ */
+void
+FrameCapture::writeY4m(SDL_Surface *rgb)
+{
+    int count = rgb->w * rgb->h;
+    std::vector<Uint8> planes(3 * count);
+    for (int y = 0; y < rgb->h; ++y) {
+        Uint8 *p = static_cast<Uint8*>(rgb->pixels) + y * rgb->pitch;
+        for (int x = 0; x < rgb->w; ++x, p += 3) {
+            int r = p[0];
+            int g = p[1];
+            int b = p[2];
+            int i = y * rgb->w + x;
+            planes[i] = (66 * r + 129 * g + 25 * b + 128) / 256 + 16;
+            planes[count + i] =
+                (-38 * r - 74 * g + 112 * b + 128) / 256 + 128;
+            planes[2 * count + i] =
+                (112 * r - 94 * g - 18 * b + 128) / 256 + 128;
+        }
+    }
+
+    fputs("FRAME\n", m_stream);
+    fwrite(&planes[0], 1, planes.size(), m_stream);
+}
@@ -0,0 +1,60 @@
+#ifndef HEADER_FRAMECAPTURE_H
+#define HEADER_FRAMECAPTURE_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <deque>
+#include <stdio.h>
+
+/**
+ * Capture pushed frames.
+ * Frames are copied into a bounded queue
+ * and a writer thread encodes them.
+ * Full queue blocks the game, no frame is dropped.
+ *
+ * Formats:
+ * - ppm ... image sequence path-NNNNNN.ppm
+ * - raw ... RGB24 frames in one file
+ * - y4m ... YUV4MPEG2 stream with 4:4:4 planes
+ *
+ * A stream is continued in a new file path-N.ext
+ * when the frame size changes.
+ */
+class FrameCapture : public NoCopy {
+    private:
+        static const unsigned int QUEUE_SIZE = 8;
+        typedef std::deque<SDL_Surface*> t_frames;
+        t_frames m_frames;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_notEmpty;
+        SDL_cond *m_notFull;
+        SDL_Thread *m_thread;
+        bool m_finished;
+        std::string m_path;
+        std::string m_format;
+        int m_fps;
+        FILE *m_stream;
+        bool m_failed;
+        int m_written;
+        int m_segment;
+        int m_width;
+        int m_height;
+    private:
+        static int writerMain(void *capture);
+        void writeLoop();
+        void writeFrame(SDL_Surface *rgb);
+        std::string getStreamPath() const;
+        bool openStream(SDL_Surface *rgb);
+        void writeY4m(SDL_Surface *rgb);
+    public:
+        FrameCapture(const std::string &path, const std::string &format,
+                int fps);
+        ~FrameCapture();
+
+        void pushFrame(SDL_Surface *screen);
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "FrameDump.h"
+
+#include "Log.h"
+#include "SDLException.h"
+
+//-----------------------------------------------------------------
+/**
+ * Prepare dump.
+ * @param dumpFrame number of the only dumped frame or 0
+ * @param dumpEvery dump every Kth frame or 0
+ * @param prefix file name prefix
+ * @param format "ppm" or "bmp"
+ */
+FrameDump::FrameDump(int dumpFrame, int dumpEvery,
+        const std::string &prefix, const std::string &format)
+    : m_prefix(prefix), m_format(format)
+{
+    m_frame = 0;
+    m_dumpFrame = dumpFrame;
+    m_dumpEvery = dumpEvery;
+    if (m_format != "bmp") {
+        m_format = "ppm";
+    }
+}
+//-----------------------------------------------------------------
+bool
+FrameDump::isSelected() const
+{
+    return m_frame == m_dumpFrame
+        || (m_dumpEvery > 0 && m_frame % m_dumpEvery == 0);
+}
+//-----------------------------------------------------------------
+std::string
+FrameDump::getFilename() const
+{
+    char number[16];
+    sprintf(number, "%06d", m_frame);
+    return m_prefix + "-" + number + "." + m_format;
+}
+//-----------------------------------------------------------------
+/**
+ * Count drawn frame and save it when selected.
+ * @throws SDLException when frame cannot be converted
+ */
+void
+FrameDump::noteFrame(SDL_Surface *screen)
+{
+    m_frame++;
+    if (!isSelected()) {
+        return;
+    }
+
+    std::string filename = getFilename();
+    bool ok = false;
+    if (m_format == "bmp") {
+        ok = (0 == SDL_SaveBMP(screen, filename.c_str()));
+    }
+    else {
+        FILE *file = fopen(filename.c_str(), "wb");
+        if (file) {
+            SDL_Surface *rgb = createRgb(screen);
+            writePpm(rgb, file);
+            SDL_FreeSurface(rgb);
+            ok = (0 == fclose(file));
+        }
+    }
+
+    if (!ok) {
+        LOG_WARNING(ExInfo("cannot dump frame")
+                .addInfo("file", filename));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Create copy with 24bit RGB pixels in byte order.
+ * @throws SDLException when surface cannot be created
+ */
+SDL_Surface *
+FrameDump::createRgb(SDL_Surface *surface)
+{
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    Uint32 rmask = 0xff0000;
+    Uint32 gmask = 0x00ff00;
+    Uint32 bmask = 0x0000ff;
+#else
+    Uint32 rmask = 0x0000ff;
+    Uint32 gmask = 0x00ff00;
+    Uint32 bmask = 0xff0000;
+#endif
+    SDL_Surface *rgb = SDL_CreateRGBSurface(SDL_SWSURFACE,
+            surface->w, surface->h, 24, rmask, gmask, bmask, 0);
+    if (NULL == rgb) {
+        throw SDLException(ExInfo("CreateRGBSurface"));
+    }
+    SDL_BlitSurface(surface, NULL, rgb, NULL);
+    return rgb;
+}
+//-----------------------------------------------------------------
+/**
+ * Write binary PPM.
+ * @param rgb surface created by createRgb()
+ * @param file opened output
+ */
+void
+FrameDump::writePpm(SDL_Surface *rgb, FILE *file)
+{
+    fprintf(file, "P6\n%d %d\n255\n", rgb->w, rgb->h);
+    for (int y = 0; y < rgb->h; ++y) {
+        fwrite(static_cast<Uint8*>(rgb->pixels) + y * rgb->pitch,
+                3, rgb->w, file);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef HEADER_FRAMEDUMP_H
+#define HEADER_FRAMEDUMP_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <stdio.h>
+
+/**
+ * Save selected drawn frames to files.
+ * Frames are numbered from 1.
+ */
+class FrameDump : public NoCopy {
+    private:
+        int m_frame;
+        int m_dumpFrame;
+        int m_dumpEvery;
+        std::string m_prefix;
+        std::string m_format;
+    private:
+        bool isSelected() const;
+        std::string getFilename() const;
+    public:
+        FrameDump(int dumpFrame, int dumpEvery,
+                const std::string &prefix, const std::string &format);
+        void noteFrame(SDL_Surface *screen);
+
+        static SDL_Surface *createRgb(SDL_Surface *surface);
+        static void writePpm(SDL_Surface *rgb, FILE *file);
+};
+
+#endif
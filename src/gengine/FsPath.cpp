@@ -16,6 +16,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <dirent.h>
 
 //-----------------------------------------------------------------
 /**
@@ -118,4 +119,38 @@ FsPath::createPath(const std::string &file)
         createDir(parent);
     }
 }
+//-----------------------------------------------------------------
+/**
+ * List names of files and subdirectories.
+ * Hidden entries are skipped, unreadable dir is empty.
+ * @param dir posix filename
+ * @param files place to add file names
+ * @param dirs place to add subdirectory names
+ */
+void
+FsPath::listDir(const std::string &dir, std::vector<std::string> *files,
+        std::vector<std::string> *dirs)
+{
+    DIR *handle = opendir(dir.c_str());
+    if (NULL == handle) {
+        return;
+    }
 
+    struct dirent *item;
+    while ((item = readdir(handle)) != NULL) {
+        std::string name = item->d_name;
+        if (name.empty() || name[0] == '.') {
+            continue;
+        }
+        struct stat buf;
+        if (0 == stat(join(dir, name).c_str(), &buf)) {
+            if (S_ISDIR(buf.st_mode)) {
+                dirs->push_back(name);
+            }
+            else {
+                files->push_back(name);
+            }
+        }
+    }
+    closedir(handle);
+}
@@ -2,6 +2,7 @@
 #define HEADER_FSPATH_H
 
 #include <string>
+#include <vector>
 
 /**
  * File system path.
@@ -14,6 +15,9 @@ class FsPath {
         static std::string join(const std::string &dir,
                 const std::string &file);
         static void createPath(const std::string &dir);
+        static void listDir(const std::string &dir,
+                std::vector<std::string> *files,
+                std::vector<std::string> *dirs);
 };
 
 #endif
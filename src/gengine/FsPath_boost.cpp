@@ -69,4 +69,37 @@ FsPath::createPath(const std::string &file)
 {
     boost::filesystem::create_directories(boostPath(file).branch_path());
 }
-
+//-----------------------------------------------------------------
+/**
+ * List names of files and subdirectories.
+ * Hidden entries are skipped, unreadable dir is empty.
+ * @param dir posix filename
+ * @param files place to add file names
+ * @param dirs place to add subdirectory names
+ */
+void
+FsPath::listDir(const std::string &dir, std::vector<std::string> *files,
+        std::vector<std::string> *dirs)
+{
+    try {
+        boost::filesystem::directory_iterator end;
+        for (boost::filesystem::directory_iterator i(boostPath(dir));
+                i != end; ++i) {
+            std::string name = i->leaf();
+            if (name.empty() || name[0] == '.') {
+                continue;
+            }
+            if (boost::filesystem::is_directory(*i)) {
+                dirs->push_back(name);
+            }
+            else {
+                files->push_back(name);
+            }
+        }
+    }
+    catch (boost::filesystem::filesystem_error &e) {
+        LOG_DEBUG(ExInfo("cannot list dir")
+                .addInfo("dir", dir)
+                .addInfo("error", e.what()));
+    }
+}
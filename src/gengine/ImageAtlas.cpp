@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ImageAtlas.h"
+
+#include "SDLException.h"
+#include "minmax.h"
+
+#include <algorithm>
+
+namespace {
+/**
+ * Orders images by format and by height of their trimmed content.
+ * Images of the same height fill one shelf.
+ */
+class HigherTrim {
+    private:
+        const std::map<SDL_Surface*,SDL_Rect> &m_trims;
+    public:
+        explicit HigherTrim(const std::map<SDL_Surface*,SDL_Rect> &trims)
+            : m_trims(trims) {}
+        bool operator()(SDL_Surface *a, SDL_Surface *b) const
+        {
+            if (a->format->Amask != b->format->Amask) {
+                return a->format->Amask < b->format->Amask;
+            }
+            return m_trims.find(a)->second.h > m_trims.find(b)->second.h;
+        }
+};
+
+/**
+ * Lock surface for direct pixel access.
+ */
+class PixelLock {
+    private:
+        SDL_Surface *m_surface;
+    public:
+        explicit PixelLock(SDL_Surface *surface) : m_surface(surface)
+        {
+            if (SDL_LockSurface(m_surface) < 0) {
+                throw SDLException(ExInfo("LockSurface"));
+            }
+        }
+        ~PixelLock() { SDL_UnlockSurface(m_surface); }
+};
+}
+
+//-----------------------------------------------------------------
+ImageAtlas::ImageAtlas()
+{
+    /* empty */
+}
+//-----------------------------------------------------------------
+ImageAtlas::~ImageAtlas()
+{
+    //NOTE: views share pixels with pages, they must be freed before
+    t_surfaces::iterator end = m_pages.end();
+    for (t_surfaces::iterator i = m_pages.begin(); i != end; ++i) {
+        SDL_FreeSurface(*i);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Find bounding box of visible pixels.
+ * Empty image is trimmed to one pixel.
+ */
+SDL_Rect
+ImageAtlas::findContent(SDL_Surface *image)
+{
+    SDL_Rect result;
+    result.x = 0;
+    result.y = 0;
+    result.w = image->w;
+    result.h = image->h;
+
+    Uint32 alphaMask = image->format->Amask;
+    bool keyed = image->flags & SDL_SRCCOLORKEY;
+    if (alphaMask == 0 && !keyed) {
+        return result;
+    }
+    Uint32 colorkey = image->format->colorkey;
+
+    int minX = image->w;
+    int minY = image->h;
+    int maxX = -1;
+    int maxY = -1;
+    PixelLock lock(image);
+    for (int y = 0; y < image->h; ++y) {
+        Uint32 *row = reinterpret_cast<Uint32*>(
+                static_cast<Uint8*>(image->pixels) + y * image->pitch);
+        for (int x = 0; x < image->w; ++x) {
+            bool visible = keyed ? row[x] != colorkey : row[x] & alphaMask;
+            if (visible) {
+                minX = min(minX, x);
+                maxX = max(maxX, x);
+                minY = min(minY, y);
+                maxY = y;
+            }
+        }
+    }
+
+    if (maxX < 0) {
+        result.w = 1;
+        result.h = 1;
+    }
+    else {
+        result.x = minX;
+        result.y = minY;
+        result.w = maxX - minX + 1;
+        result.h = maxY - minY + 1;
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Only 32bit images with the same colors as the first image
+ * can be packed together.
+ * Images with alpha and colorkey images use separate pages.
+ */
+bool
+ImageAtlas::isPackable(SDL_Surface *image) const
+{
+    if (image->format->BytesPerPixel != 4
+            || image->w > PAGE_SIZE || image->h > PAGE_SIZE) {
+        return false;
+    }
+    if (m_images.empty()) {
+        return true;
+    }
+
+    const SDL_PixelFormat *first = m_images.front()->format;
+    return first->Rmask == image->format->Rmask
+        && first->Gmask == image->format->Gmask
+        && first->Bmask == image->format->Bmask;
+}
+//-----------------------------------------------------------------
+/**
+ * Create a transparent page.
+ * @throws SDLException when page cannot be created
+ */
+SDL_Surface *
+ImageAtlas::createPage(SDL_Surface *sample)
+{
+    SDL_Surface *page = SDL_CreateRGBSurface(SDL_SWSURFACE,
+            PAGE_SIZE, PAGE_SIZE, sample->format->BitsPerPixel,
+            sample->format->Rmask, sample->format->Gmask,
+            sample->format->Bmask, sample->format->Amask);
+    if (NULL == page) {
+        throw SDLException(ExInfo("CreateRGBSurface")
+                .addInfo("size", PAGE_SIZE));
+    }
+    Uint32 clear = (sample->flags & SDL_SRCCOLORKEY) ?
+        sample->format->colorkey : 0;
+    SDL_FillRect(page, NULL, clear);
+    m_pages.push_back(page);
+    return page;
+}
+//-----------------------------------------------------------------
+/**
+ * Copy raw pixels, no blending is done.
+ */
+void
+ImageAtlas::copyRect(SDL_Surface *src, const SDL_Rect &src_rect,
+        SDL_Surface *dest, int x, int y)
+{
+    PixelLock srcLock(src);
+    PixelLock destLock(dest);
+    int bpp = src->format->BytesPerPixel;
+    for (int row = 0; row < src_rect.h; ++row) {
+        memcpy(static_cast<Uint8*>(dest->pixels)
+                + (y + row) * dest->pitch + x * bpp,
+                static_cast<Uint8*>(src->pixels)
+                + (src_rect.y + row) * src->pitch + src_rect.x * bpp,
+                src_rect.w * bpp);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Use the same alpha and colorkey settings.
+ */
+void
+ImageAtlas::copyFlags(SDL_Surface *src, SDL_Surface *dest)
+{
+    Uint32 rle = (src->flags & (SDL_RLEACCEL | SDL_RLEACCELOK)) ?
+        SDL_RLEACCEL : 0;
+    if (src->flags & SDL_SRCALPHA) {
+        SDL_SetAlpha(dest, SDL_SRCALPHA | rle, src->format->alpha);
+    }
+    else {
+        SDL_SetAlpha(dest, 0, SDL_ALPHA_OPAQUE);
+    }
+    if (src->flags & SDL_SRCCOLORKEY) {
+        SDL_SetColorKey(dest, SDL_SRCCOLORKEY | rle, src->format->colorkey);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Remember image for packing.
+ * Unsupported images are ignored, they will be used as they are.
+ */
+void
+ImageAtlas::addImage(SDL_Surface *image)
+{
+    if (m_trims.find(image) == m_trims.end() && isPackable(image)) {
+        m_trims[image] = findContent(image);
+        m_images.push_back(image);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Pack all added images into pages.
+ * Simple shelf packing is used, sprites from one level
+ * have similar heights.
+ *
+ * @throws SDLException when page cannot be created
+ */
+void
+ImageAtlas::pack()
+{
+    std::stable_sort(m_images.begin(), m_images.end(), HigherTrim(m_trims));
+
+    SDL_Surface *page = NULL;
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfH = 0;
+    t_surfaces::iterator end = m_images.end();
+    for (t_surfaces::iterator i = m_images.begin(); i != end; ++i) {
+        const SDL_Rect &trim = m_trims[*i];
+        if (shelfX + trim.w > PAGE_SIZE) {
+            shelfY += shelfH;
+            shelfX = 0;
+            shelfH = 0;
+        }
+        if (NULL == page || shelfY + trim.h > PAGE_SIZE
+                || page->format->Amask != (*i)->format->Amask) {
+            page = createPage(*i);
+            shelfX = 0;
+            shelfY = 0;
+            shelfH = 0;
+        }
+
+        copyRect(*i, trim, page, shelfX, shelfY);
+        Place place;
+        place.page = m_pages.size() - 1;
+        place.rect.x = shelfX;
+        place.rect.y = shelfY;
+        place.rect.w = trim.w;
+        place.rect.h = trim.h;
+        m_places[*i] = place;
+
+        shelfX += trim.w;
+        shelfH = max(shelfH, static_cast<int>(trim.h));
+    }
+    m_images.clear();
+}
+//-----------------------------------------------------------------
+/**
+ * Create view for packed image.
+ * The view shares pixels with the page, it is freed as usual surface.
+ * NOTE: must be called before the original image is freed.
+ *
+ * @param image original image
+ * @param trim place to store offset of the view and original size
+ * @return new view or NULL when image was not packed
+ * @throws SDLException when view cannot be created
+ */
+SDL_Surface *
+ImageAtlas::createView(SDL_Surface *image, SDL_Rect *trim) const
+{
+    t_places::const_iterator it = m_places.find(image);
+    if (it == m_places.end()) {
+        return NULL;
+    }
+
+    const Place &place = it->second;
+    SDL_Surface *page = m_pages[place.page];
+    SDL_PixelFormat *fmt = page->format;
+    SDL_Surface *view = SDL_CreateRGBSurfaceFrom(
+            static_cast<Uint8*>(page->pixels)
+            + place.rect.y * page->pitch + place.rect.x * fmt->BytesPerPixel,
+            place.rect.w, place.rect.h, fmt->BitsPerPixel, page->pitch,
+            fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+    if (NULL == view) {
+        throw SDLException(ExInfo("CreateRGBSurfaceFrom"));
+    }
+    copyFlags(image, view);
+
+    *trim = m_trims.find(image)->second;
+    trim->w = image->w;
+    trim->h = image->h;
+    return view;
+}
+//-----------------------------------------------------------------
+/**
+ * Create temporary copy of the original image.
+ * It is used by effects which need the whole image.
+ *
+ * @param view trimmed view
+ * @param trim offset of the view and original size
+ * @return new surface, caller must free it
+ * @throws SDLException when surface cannot be created
+ */
+SDL_Surface *
+ImageAtlas::createUntrimmed(SDL_Surface *view, const SDL_Rect &trim)
+{
+    SDL_PixelFormat *fmt = view->format;
+    SDL_Surface *result = SDL_CreateRGBSurface(SDL_SWSURFACE,
+            trim.w, trim.h, fmt->BitsPerPixel,
+            fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+    if (NULL == result) {
+        throw SDLException(ExInfo("CreateRGBSurface"));
+    }
+    Uint32 clear = (view->flags & SDL_SRCCOLORKEY) ? fmt->colorkey : 0;
+    SDL_FillRect(result, NULL, clear);
+    copyFlags(view, result);
+
+    SDL_Rect all;
+    all.x = 0;
+    all.y = 0;
+    all.w = view->w;
+    all.h = view->h;
+    copyRect(view, all, result, trim.x, trim.y);
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef HEADER_IMAGEATLAS_H
+#define HEADER_IMAGEATLAS_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <vector>
+#include <map>
+
+/**
+ * A few large surfaces with packed images.
+ * Transparent margins are trimmed,
+ * packed images are returned as views into the atlas pages.
+ *
+ * Trim rect describes the view inside the original image,
+ * x, y is offset of the view and w, h is size of the original image.
+ */
+class ImageAtlas : public NoCopy {
+    private:
+        static const int PAGE_SIZE = 1024;
+        struct Place {
+            int page;
+            SDL_Rect rect;
+        };
+        typedef std::vector<SDL_Surface*> t_surfaces;
+        typedef std::map<SDL_Surface*,SDL_Rect> t_trims;
+        typedef std::map<SDL_Surface*,Place> t_places;
+        t_surfaces m_images;
+        t_surfaces m_pages;
+        t_trims m_trims;
+        t_places m_places;
+    private:
+        static SDL_Rect findContent(SDL_Surface *image);
+        bool isPackable(SDL_Surface *image) const;
+        SDL_Surface *createPage(SDL_Surface *sample);
+        static void copyRect(SDL_Surface *src, const SDL_Rect &src_rect,
+                SDL_Surface *dest, int x, int y);
+        static void copyFlags(SDL_Surface *src, SDL_Surface *dest);
+    public:
+        ImageAtlas();
+        virtual ~ImageAtlas();
+
+        void addImage(SDL_Surface *image);
+        void pack();
+        SDL_Surface *createView(SDL_Surface *image, SDL_Rect *trim) const;
+        int countPages() const { return m_pages.size(); }
+
+        static SDL_Surface *createUntrimmed(SDL_Surface *view,
+                const SDL_Rect &trim);
+};
+
+#endif
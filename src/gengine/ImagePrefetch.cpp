@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ImagePrefetch.h"
+
+#include "Log.h"
+#include "SDLException.h"
+#include "OptionAgent.h"
+
+#include "SDL_image.h"
+
+ImagePrefetch *ImagePrefetch::ms_prefetch = NULL;
+
+//-----------------------------------------------------------------
+/**
+ * Start decoder thread.
+ * @throws SDLException when thread cannot be created
+ */
+ImagePrefetch::ImagePrefetch()
+{
+    m_quit = false;
+    m_mutex = SDL_CreateMutex();
+    m_wake = SDL_CreateCond();
+    m_finished = SDL_CreateCond();
+    if (NULL == m_mutex || NULL == m_wake || NULL == m_finished) {
+        throw SDLException(ExInfo("CreateMutex"));
+    }
+
+    m_thread = SDL_CreateThread(decoderMain, this);
+    if (NULL == m_thread) {
+        throw SDLException(ExInfo("CreateThread"));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Stop decoder and free unused images.
+ */
+ImagePrefetch::~ImagePrefetch()
+{
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    m_queue.clear();
+    SDL_CondSignal(m_wake);
+    SDL_UnlockMutex(m_mutex);
+    SDL_WaitThread(m_thread, NULL);
+
+    t_decoded::iterator end = m_done.end();
+    for (t_decoded::iterator i = m_done.begin(); i != end; ++i) {
+        SDL_FreeSurface(i->raw);
+    }
+    SDL_DestroyCond(m_finished);
+    SDL_DestroyCond(m_wake);
+    SDL_DestroyMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Create shared decoder when "prefetch_images" option is enabled.
+ */
+void
+ImagePrefetch::init()
+{
+    if (NULL == ms_prefetch
+            && OptionAgent::agent()->getAsBool("prefetch_images", true)) {
+        try {
+            ms_prefetch = new ImagePrefetch();
+        }
+        catch (SDLException &e) {
+            LOG_WARNING(e.info());
+        }
+    }
+}
+//-----------------------------------------------------------------
+void
+ImagePrefetch::shutdown()
+{
+    delete ms_prefetch;
+    ms_prefetch = NULL;
+}
+//-----------------------------------------------------------------
+int
+ImagePrefetch::decoderMain(void *prefetch)
+{
+    static_cast<ImagePrefetch*>(prefetch)->work();
+    return 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Decode queued files one by one.
+ * Unreadable files are only logged, prefetch is just a hint.
+ */
+void
+ImagePrefetch::work()
+{
+    SDL_LockMutex(m_mutex);
+    while (true) {
+        while (!m_quit && m_queue.empty()) {
+            SDL_CondWait(m_wake, m_mutex);
+        }
+        if (m_quit) {
+            break;
+        }
+        m_current = m_queue.front();
+        m_queue.pop_front();
+        SDL_UnlockMutex(m_mutex);
+
+        SDL_Surface *raw = IMG_Load(m_current.c_str());
+
+        SDL_LockMutex(m_mutex);
+        if (raw) {
+            Decoded decoded;
+            decoded.file = m_current;
+            decoded.raw = raw;
+            m_done.push_back(decoded);
+        }
+        else {
+            LOG_DEBUG(ExInfo("cannot prefetch image")
+                    .addInfo("file", m_current));
+        }
+        m_current = "";
+        SDL_CondBroadcast(m_finished);
+    }
+    SDL_UnlockMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Return true when the file is queued, decoded or being decoded.
+ * NOTE: mutex must be locked
+ */
+bool
+ImagePrefetch::isKnown(const std::string &file) const
+{
+    if (file == m_current) {
+        return true;
+    }
+    t_files::const_iterator queueEnd = m_queue.end();
+    for (t_files::const_iterator i = m_queue.begin(); i != queueEnd; ++i) {
+        if (*i == file) {
+            return true;
+        }
+    }
+    t_decoded::const_iterator doneEnd = m_done.end();
+    for (t_decoded::const_iterator i = m_done.begin(); i != doneEnd; ++i) {
+        if (i->file == file) {
+            return true;
+        }
+    }
+    return false;
+}
+//-----------------------------------------------------------------
+/**
+ * Replace waiting files with new ones.
+ * The last request is the most important one,
+ * already decoded images are kept.
+ */
+void
+ImagePrefetch::request(const std::vector<std::string> &files)
+{
+    if (NULL == ms_prefetch) {
+        return;
+    }
+
+    SDL_LockMutex(ms_prefetch->m_mutex);
+    ms_prefetch->m_queue.clear();
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        if (!ms_prefetch->isKnown(files[i])) {
+            ms_prefetch->m_queue.push_back(files[i]);
+        }
+    }
+    SDL_CondSignal(ms_prefetch->m_wake);
+    SDL_UnlockMutex(ms_prefetch->m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Take any decoded image.
+ * @param file place to store name of the image file
+ * @return raw surface or NULL when nothing is decoded
+ */
+SDL_Surface *
+ImagePrefetch::takeDone(std::string *file)
+{
+    if (NULL == ms_prefetch) {
+        return NULL;
+    }
+
+    SDL_Surface *result = NULL;
+    SDL_LockMutex(ms_prefetch->m_mutex);
+    if (!ms_prefetch->m_done.empty()) {
+        *file = ms_prefetch->m_done.front().file;
+        result = ms_prefetch->m_done.front().raw;
+        ms_prefetch->m_done.pop_front();
+    }
+    SDL_UnlockMutex(ms_prefetch->m_mutex);
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Take the decoded image of the given file.
+ * Waits when the file is just being decoded.
+ * A waiting file is removed from queue, caller will load it itself.
+ *
+ * @return raw surface or NULL
+ */
+SDL_Surface *
+ImagePrefetch::takeDecoded(const std::string &file)
+{
+    if (NULL == ms_prefetch) {
+        return NULL;
+    }
+
+    SDL_LockMutex(ms_prefetch->m_mutex);
+    ms_prefetch->m_queue.remove(file);
+    while (file == ms_prefetch->m_current) {
+        SDL_CondWait(ms_prefetch->m_finished, ms_prefetch->m_mutex);
+    }
+
+    SDL_Surface *result = NULL;
+    t_decoded &done = ms_prefetch->m_done;
+    for (t_decoded::iterator i = done.begin(); i != done.end(); ++i) {
+        if (i->file == file) {
+            result = i->raw;
+            done.erase(i);
+            break;
+        }
+    }
+    SDL_UnlockMutex(ms_prefetch->m_mutex);
+    return result;
+}
@@ -0,0 +1,49 @@
+#ifndef HEADER_IMAGEPREFETCH_H
+#define HEADER_IMAGEPREFETCH_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <vector>
+#include <list>
+
+/**
+ * Background thread decoding image files.
+ * Decoded surfaces are raw, the main thread converts them
+ * to displayformat.
+ */
+class ImagePrefetch : public NoCopy {
+    private:
+        struct Decoded {
+            std::string file;
+            SDL_Surface *raw;
+        };
+        typedef std::list<std::string> t_files;
+        typedef std::list<Decoded> t_decoded;
+        static ImagePrefetch *ms_prefetch;
+        t_files m_queue;
+        t_decoded m_done;
+        std::string m_current;
+        SDL_Thread *m_thread;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_wake;
+        SDL_cond *m_finished;
+        bool m_quit;
+    private:
+        ImagePrefetch();
+        static int decoderMain(void *prefetch);
+        void work();
+        bool isKnown(const std::string &file) const;
+    public:
+        ~ImagePrefetch();
+        static void init();
+        static void shutdown();
+
+        static void request(const std::vector<std::string> &files);
+        static SDL_Surface *takeDone(std::string *file);
+        static SDL_Surface *takeDecoded(const std::string &file);
+};
+
+#endif
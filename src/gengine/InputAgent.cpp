@@ -16,6 +16,7 @@
 #include "UnknownMsgException.h"
 #include "Name.h"
 #include "MouseStroke.h"
+#include "VideoAgent.h"
 
 #include "SDL.h"
 
@@ -64,7 +65,13 @@ InputAgent::own_update()
                 break;
             case SDL_MOUSEBUTTONDOWN:
                 if (m_handler) {
-                    m_handler->mouseEvent(MouseStroke(event.button));
+                    V2 loc = VideoAgent::agent()->toScreenLoc(
+                            V2(event.button.x, event.button.y));
+                    if (loc.getX() >= 0) {
+                        event.button.x = loc.getX();
+                        event.button.y = loc.getY();
+                        m_handler->mouseEvent(MouseStroke(event.button));
+                    }
                 }
                 break;
             default:
@@ -105,7 +112,7 @@ InputAgent::installHandler(InputHandler *handler)
 }
 //-----------------------------------------------------------------
 /**
- * Return mouse location.
+ * Return mouse location on the drawn screen.
  * @param out_buttons place where to store state of buttons
  * @return (mouseX, mouseY)
  */
@@ -118,7 +125,7 @@ InputAgent::getMouseState(Uint8 *out_buttons)
     if (out_buttons) {
         *out_buttons = pressed;
     }
-    return V2(x, y);
+    return VideoAgent::agent()->toScreenLoc(V2(x, y));
 }
 
 
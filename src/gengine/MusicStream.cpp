@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "MusicStream.h"
+
+#include "Log.h"
+#include "SDLException.h"
+#include "minmax.h"
+
+#include "SDL_mixer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef HAVE_VORBISFILE
+#include <vorbis/vorbisfile.h>
+#endif
+
+//-----------------------------------------------------------------
+/**
+ * Start decoding.
+ * Nothing is read in the caller thread.
+ *
+ * @param file native path to ogg file
+ * @param startLoop loop start at 22050 Hz
+ * @param endLoop loop end at 22050 Hz, negative for end of file
+ * @throws SDLException when decoder thread cannot be started
+ */
+MusicStream::MusicStream(const std::string &file,
+        long startLoop, long endLoop)
+    : m_file(file)
+{
+    m_startLoop = startLoop;
+    m_endLoop = endLoop;
+    Mix_QuerySpec(&m_frequency, &m_format, &m_channels);
+
+    m_ring = new Uint8[RING_BYTES];
+    m_readPos = 0;
+    m_filled = 0;
+    m_underruns = 0;
+    m_playing = false;
+    m_quit = false;
+    m_mutex = SDL_CreateMutex();
+    m_space = SDL_CreateCond();
+    if (NULL == m_mutex || NULL == m_space) {
+        throw SDLException(ExInfo("CreateMutex"));
+    }
+    m_thread = SDL_CreateThread(decoderMain, this);
+    if (NULL == m_thread) {
+        throw SDLException(ExInfo("CreateThread"));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Stop decoder.
+ * NOTE: the stream must not be read any more
+ */
+MusicStream::~MusicStream()
+{
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    SDL_CondSignal(m_space);
+    SDL_UnlockMutex(m_mutex);
+    SDL_WaitThread(m_thread, NULL);
+
+    if (m_underruns > 0) {
+        LOG_INFO(ExInfo("music stream was late")
+                .addInfo("file", m_file)
+                .addInfo("underruns", m_underruns));
+    }
+    SDL_DestroyCond(m_space);
+    SDL_DestroyMutex(m_mutex);
+    delete[] m_ring;
+}
+//-----------------------------------------------------------------
+int
+MusicStream::decoderMain(void *stream)
+{
+    static_cast<MusicStream*>(stream)->decode();
+    return 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Decode file into ring buffer until stopped.
+ * Samples are converted to the mixer format in blocks.
+ */
+void
+MusicStream::decode()
+{
+#ifdef HAVE_VORBISFILE
+    FILE *input = fopen(m_file.c_str(), "rb");
+    if (NULL == input) {
+        LOG_WARNING(ExInfo("cannot open music")
+                .addInfo("music", m_file));
+        return;
+    }
+    OggVorbis_File vf;
+    if (ov_open(input, &vf, NULL, 0) != 0) {
+        fclose(input);
+        LOG_WARNING(ExInfo("cannot decode music")
+                .addInfo("music", m_file));
+        return;
+    }
+
+    vorbis_info *info = ov_info(&vf, -1);
+    ogg_int64_t total = ov_pcm_total(&vf, -1);
+    ogg_int64_t start = static_cast<ogg_int64_t>(m_startLoop)
+        * info->rate / 22050;
+    ogg_int64_t end = total;
+    if (m_endLoop >= 0) {
+        end = min(total,
+                static_cast<ogg_int64_t>(m_endLoop) * info->rate / 22050);
+    }
+    if (start >= end) {
+        start = 0;
+    }
+
+    SDL_AudioCVT cvt;
+    SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, info->channels, info->rate,
+            m_format, m_channels, m_frequency);
+    int frameBytes = 2 * info->channels;
+    Uint8 *block = static_cast<Uint8*>(
+            malloc(DECODE_BYTES * max(1, cvt.len_mult)));
+    int bigEndian = (SDL_BYTEORDER == SDL_BIG_ENDIAN) ? 1 : 0;
+
+    bool running = (block != NULL && end > 0);
+    while (running) {
+        ogg_int64_t pos = ov_pcm_tell(&vf);
+        if (pos >= end) {
+            if (ov_pcm_seek(&vf, start) != 0) {
+                break;
+            }
+            continue;
+        }
+
+        int wanted = DECODE_BYTES - DECODE_BYTES % frameBytes;
+        if ((end - pos) * frameBytes < wanted) {
+            wanted = static_cast<int>(end - pos) * frameBytes;
+        }
+        int section;
+        long got = ov_read(&vf, reinterpret_cast<char*>(block), wanted,
+                bigEndian, 2, 1, &section);
+        if (got == 0) {
+            if (pos <= start) {
+                break;
+            }
+            end = pos;
+            continue;
+        }
+        else if (got < 0) {
+            LOG_WARNING(ExInfo("music decoding error")
+                    .addInfo("music", m_file)
+                    .addInfo("error", got));
+            break;
+        }
+
+        cvt.buf = block;
+        cvt.len = got - got % frameBytes;
+        if (cvt.needed) {
+            SDL_ConvertAudio(&cvt);
+        }
+        else {
+            cvt.len_cvt = cvt.len;
+        }
+        running = push(block, cvt.len_cvt);
+    }
+    free(block);
+    ov_clear(&vf);
+#else
+    LOG_WARNING(ExInfo("music streaming is not supported")
+            .addInfo("music", m_file));
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * Write samples into ring buffer.
+ * Waits for free space.
+ * @return false when the stream is stopped
+ */
+bool
+MusicStream::push(const Uint8 *data, int length)
+{
+    SDL_LockMutex(m_mutex);
+    while (length > 0 && !m_quit) {
+        while (!m_quit && m_filled == RING_BYTES) {
+            SDL_CondWait(m_space, m_mutex);
+        }
+        if (m_quit) {
+            break;
+        }
+        int writePos = (m_readPos + m_filled) % RING_BYTES;
+        int count = min(length, min(RING_BYTES - m_filled,
+                    RING_BYTES - writePos));
+        SDL_UnlockMutex(m_mutex);
+
+        //NOTE: reader does not touch the free space
+        memcpy(m_ring + writePos, data, count);
+        data += count;
+        length -= count;
+
+        SDL_LockMutex(m_mutex);
+        m_filled += count;
+        m_playing = true;
+    }
+    bool result = !m_quit;
+    SDL_UnlockMutex(m_mutex);
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Take decoded samples.
+ * Called from audio callback, it never waits for decoder.
+ *
+ * @param buffer place for samples in the mixer format
+ * @param length wanted number of bytes
+ * @return number of bytes stored
+ */
+int
+MusicStream::read(Uint8 *buffer, int length)
+{
+    SDL_LockMutex(m_mutex);
+    int result = 0;
+    while (result < length && m_filled > 0) {
+        int count = min(length - result,
+                min(m_filled, RING_BYTES - m_readPos));
+        memcpy(buffer + result, m_ring + m_readPos, count);
+        result += count;
+        m_readPos = (m_readPos + count) % RING_BYTES;
+        m_filled -= count;
+    }
+    if (result < length && m_playing) {
+        m_underruns++;
+    }
+    SDL_CondSignal(m_space);
+    SDL_UnlockMutex(m_mutex);
+    return result;
+}
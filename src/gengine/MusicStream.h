@@ -0,0 +1,46 @@
+#ifndef HEADER_MUSICSTREAM_H
+#define HEADER_MUSICSTREAM_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+
+/**
+ * Ogg music decoded on background into a ring buffer.
+ * Music is repeated between loop points,
+ * the points are in samples at 22050 Hz like in *.ogg.meta.
+ */
+class MusicStream : public NoCopy {
+    private:
+        static const int RING_BYTES = 256 * 1024;
+        static const int DECODE_BYTES = 16 * 1024;
+        std::string m_file;
+        long m_startLoop;
+        long m_endLoop;
+        int m_frequency;
+        Uint16 m_format;
+        int m_channels;
+
+        Uint8 *m_ring;
+        int m_readPos;
+        int m_filled;
+        int m_underruns;
+        bool m_playing;
+        bool m_quit;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_space;
+        SDL_Thread *m_thread;
+    private:
+        static int decoderMain(void *stream);
+        void decode();
+        bool push(const Uint8 *data, int length);
+    public:
+        MusicStream(const std::string &file, long startLoop, long endLoop);
+        ~MusicStream();
+
+        int read(Uint8 *buffer, int length);
+};
+
+#endif
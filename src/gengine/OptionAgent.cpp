@@ -9,6 +9,7 @@
 #include "OptionAgent.h"
 
 #include "Environ.h"
+#include "ConfigWriter.h"
 
 #include "Log.h"
 #include "Path.h"
@@ -52,11 +53,25 @@ const char *OptionAgent::CONFIG_FILE = "script/options.lua";
 OptionAgent::own_init()
 {
     m_environ = new Environ();
+    m_persistent = NULL;
+    m_flushTime = 0;
+    m_writer = new ConfigWriter();
     prepareVersion();
     prepareDataPaths();
     prepareLang();
 }
 //-----------------------------------------------------------------
+/**
+ * Flush changed persistent options when their time comes.
+ */
+    void
+OptionAgent::own_update()
+{
+    if (!m_dirty.empty() && SDL_GetTicks() >= m_flushTime) {
+        flushPersistent();
+    }
+}
+//-----------------------------------------------------------------
 /**
  * Save user config.
  * Delete left messages.
@@ -64,6 +79,11 @@ OptionAgent::own_init()
     void
 OptionAgent::own_shutdown()
 {
+    if (!m_dirty.empty()) {
+        flushPersistent();
+    }
+    delete m_writer;
+    delete m_persistent;
     delete m_environ;
 }
 //-----------------------------------------------------------------
@@ -287,30 +307,20 @@ OptionAgent::getAsBool(const std::string &name,
 //-----------------------------------------------------------------
 /**
  * Set param also on disk.
- * Preserve all current params in options file.
+ * Options file is kept in memory,
+ * changed params are written together a moment later.
  */
     void
 OptionAgent::setPersistent(const std::string &name, const std::string &value)
 {
-    //NOTE: path must be created before change of environ
-    Path config = Path::dataWritePath(CONFIG_FILE);
-
-    Environ *swap_env = m_environ;
-    m_environ = new Environ();
-
-    try {
-        if (config.exists()) {
-            ScriptAgent::agent()->scriptInclude(config);
-        }
+    if (NULL == m_persistent) {
+        readPersistent();
     }
-    catch (ScriptException &e) {
-        LOG_WARNING(e.info());
+    if (m_dirty.empty()) {
+        m_flushTime = SDL_GetTicks() + FLUSH_DELAY;
     }
-    setParam(name, value);
-    m_environ->store(config);
-
-    delete m_environ;
-    m_environ = swap_env;
+    m_persistent->setParam(name, value);
+    m_dirty.insert(name);
     setParam(name, value);
 }
 //-----------------------------------------------------------------
@@ -415,6 +425,15 @@ OptionAgent::readSystemConfig()
 void
 OptionAgent::readUserConfig()
 {
+    if (m_persistent) {
+        if (!m_dirty.empty()) {
+            flushPersistent();
+        }
+        m_writer->wait();
+        delete m_persistent;
+        m_persistent = NULL;
+    }
+
     try {
         Path userConfig = Path::dataUserPath(CONFIG_FILE);
         if (userConfig.exists()) {
@@ -425,4 +444,44 @@ OptionAgent::readUserConfig()
         LOG_WARNING(e.info());
     }
 }
+//-----------------------------------------------------------------
+/**
+ * Read params from user options file into memory.
+ * Current params are preserved.
+ * The file is remembered, so pending params are written there
+ * also when userdir is changed before flush.
+ */
+void
+OptionAgent::readPersistent()
+{
+    Path config = Path::dataUserPath(CONFIG_FILE);
+    Environ *swap_env = m_environ;
+    m_persistent = new Environ();
+    m_environ = m_persistent;
+
+    try {
+        if (config.exists()) {
+            ScriptAgent::agent()->scriptInclude(config);
+        }
+    }
+    catch (ScriptException &e) {
+        LOG_WARNING(e.info());
+    }
+    m_environ = swap_env;
 
+    //NOTE: path must be created before the writer starts
+    m_persistentFile = Path::dataWritePath(CONFIG_FILE).getNative();
+}
+//-----------------------------------------------------------------
+/**
+ * Write all persistent params in one background write.
+ */
+void
+OptionAgent::flushPersistent()
+{
+    LOG_DEBUG(ExInfo("flushing options")
+            .addInfo("changed", m_dirty.size())
+            .addInfo("file", m_persistentFile));
+    m_writer->write(m_persistentFile, m_persistent->getConfig());
+    m_dirty.clear();
+}
@@ -3,12 +3,16 @@
 
 class Environ;
 class OptionParams;
+class ConfigWriter;
 
 #include "BaseAgent.h"
 #include "Name.h"
 
+#include "SDL.h"
+
 #include <string>
 #include <map>
+#include <set>
 
 /**
  * Game options.
@@ -17,7 +21,13 @@ class OptionAgent : public BaseAgent {
     AGENT(OptionAgent, Name::OPTION_NAME);
     private:
         static const char *CONFIG_FILE;
+        static const Uint32 FLUSH_DELAY = 1000;
         Environ *m_environ;
+        Environ *m_persistent;
+        std::string m_persistentFile;
+        std::set<std::string> m_dirty;
+        Uint32 m_flushTime;
+        ConfigWriter *m_writer;
     private:
         void prepareVersion();
         void prepareDataPaths();
@@ -32,8 +42,11 @@ class OptionAgent : public BaseAgent {
         std::string getVersionInfo() const;
         void readSystemConfig();
         void readUserConfig();
+        void readPersistent();
+        void flushPersistent();
     protected:
         virtual void own_init();
+        virtual void own_update();
         virtual void own_shutdown();
     public:
         void parseCmdOpt(int argc, char *argv[],
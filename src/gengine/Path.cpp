@@ -12,6 +12,7 @@
 #include "OptionAgent.h"
 #include "Dialog.h"
 #include "FsPath.h"
+#include "DataIndex.h"
 #include "PathException.h"
 
 #include <stdio.h>
@@ -26,6 +27,8 @@
 /**
  * Try return user data path,
  * otherwise return system data path.
+ * A file missing in the index is checked on disk
+ * before it is created, so it is never truncated.
  * NOTE: OptionAgent must be initialized before this
  *
  * @param file path to file
@@ -37,7 +40,13 @@ Path::dataPath(const std::string &file, bool writeable)
 {
     Path datapath = dataUserPath(file);
 
-    if (!datapath.exists())  {
+    bool exists = datapath.exists();
+    if (!exists && writeable && FsPath::exists(datapath.getPosixName())) {
+        //NOTE: file was written without dataWritePath
+        DataIndex::noteFile(datapath.getPosixName());
+        exists = true;
+    }
+    if (!exists)  {
         FILE *try_open = NULL;
         if (writeable) {
             try {
@@ -54,6 +63,7 @@ Path::dataPath(const std::string &file, bool writeable)
 
         if (try_open) {
             fclose(try_open);
+            DataIndex::noteFile(datapath.getPosixName());
         }
         else {
             datapath = dataSystemPath(file);
@@ -157,8 +167,12 @@ Path::getNative() const
     return FsPath::getNative(m_path);
 }
 //-----------------------------------------------------------------
+/**
+ * Returns true when file exists.
+ * Data files are looked up in the data index.
+ */
 bool
 Path::exists() const
 {
-    return FsPath::exists(m_path);
+    return DataIndex::exists(m_path);
 }
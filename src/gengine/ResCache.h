@@ -6,49 +6,66 @@
 
 #include "Log.h"
 
+#include <map>
+#include <list>
+
 template <class T>
 class CacheEntry {
     public:
     std::string name;
     T value;
     int refcount;
+    unsigned int size;
+    typename std::list<CacheEntry<T>*>::iterator unusedPos;
 
     CacheEntry() {
         name = "";
         value = NULL;
         refcount = 0;
+        size = 0;
     }
 };
 
 /**
- * A fixed size cache for any resources.
+ * A cache for any resources limited by memory size.
+ * Entries are found by name and by value.
+ * Unreferenced entries are evicted in least recently used order.
  */
 template <class T>
 class ResCache : public NoCopy {
     private:
-        typedef std::vector<class CacheEntry<T>*> t_entries;
-        t_entries m_entries;
+        typedef std::map<std::string,class CacheEntry<T>*> t_names;
+        typedef std::map<T,class CacheEntry<T>*> t_values;
+        typedef std::list<class CacheEntry<T>*> t_unused;
+        t_names m_names;
+        t_values m_values;
+        t_unused m_unused;
         ResourcePack<T> *m_unloader;
-        unsigned int m_next_pos;
+        unsigned int m_budget;
+        unsigned int m_size;
+        unsigned int m_hits;
+        unsigned int m_misses;
+        unsigned int m_evictions;
     public:
         /**
-         * Creates a cache with the given capacity.
+         * Creates a cache with the given capacity in bytes.
          * The given unloader has to have disabled caching
          * to prevent an infinite loop.
          */
-        ResCache(int capacity, ResourcePack<T> *new_unloader) {
-            m_entries.resize(capacity);
-            for (unsigned int i = 0; i < m_entries.size(); i++) {
-                m_entries[i] = new CacheEntry<T>();
-            }
-
-            m_next_pos = 0;
+        ResCache(unsigned int budget, ResourcePack<T> *new_unloader) {
+            m_budget = budget;
+            m_size = 0;
+            m_hits = 0;
+            m_misses = 0;
+            m_evictions = 0;
             m_unloader = new_unloader;
         }
 
         ~ResCache() {
-            for (unsigned int i = 0; i < m_entries.size(); i++) {
-                delete m_entries[i];
+            typename t_names::iterator end = m_names.end();
+            for (typename t_names::iterator i = m_names.begin();
+                    i != end; ++i) {
+                delete i->second;
             }
             delete m_unloader;
         }
@@ -58,96 +75,97 @@ class ResCache : public NoCopy {
          * The returned item should be released via release().
          */
         T get(const std::string &name) {
-            CacheEntry<T> *entry = getEntry(name);
-            if (!entry) {
+            typename t_names::iterator it = m_names.find(name);
+            if (it == m_names.end()) {
+                m_misses++;
                 return NULL;
             }
 
+            CacheEntry<T> *entry = it->second;
+            if (entry->refcount <= 0) {
+                m_unused.erase(entry->unusedPos);
+            }
             entry->refcount++;
+            m_hits++;
             return entry->value;
         }
 
+        /**
+         * Returns true when the named value is cached.
+         * It does not count as a hit.
+         */
+        bool has(const std::string &name) const {
+            return m_names.find(name) != m_names.end();
+        }
+
         /**
          * Notes a new value.
          * The caller should release it later via release().
          */
         void put(const std::string &name, T value) {
-            CacheEntry<T>* entry = findNextUnusedEntry();
-            if (!entry) {
-                LOG_DEBUG(ExInfo("cannot fit into cache")
+            if (m_names.find(name) != m_names.end()
+                    || m_values.find(value) != m_values.end()) {
+                LOG_DEBUG(ExInfo("already in cache")
                         .addInfo("name", name));
                 return;
             }
 
-            if (entry->value != NULL) {
-                m_unloader->unloadRes(entry->value);
-            }
+            CacheEntry<T> *entry = new CacheEntry<T>();
             entry->name = name;
             entry->value = value;
             entry->refcount = 1;
+            entry->size = m_unloader->getResSize(value);
+            m_names[name] = entry;
+            m_values[value] = entry;
+            m_size += entry->size;
         }
 
         /**
          * Releases or takes responsibility for the given value.
          */
         void release(T value) {
-            CacheEntry<T> *found = getByValue(value);
-            if (found) {
-                found->refcount -= 1;
-                if (found->refcount < 0) {
-                    LOG_WARNING(ExInfo("extra release of a cache entry"));
-                    found->refcount = 0;
-                }
-            } else {
+            typename t_values::iterator it = m_values.find(value);
+            if (it == m_values.end()) {
                 m_unloader->unloadRes(value);
+                return;
             }
-        }
 
-    private:
-        /**
-         * Returns the matching CacheEntry or NULL.
-         */
-        CacheEntry<T> *getEntry(const std::string &name) {
-            for (unsigned int i = 0; i < m_entries.size(); i++) {
-                CacheEntry<T> *entry = m_entries[i];
-                if (entry->value != NULL && entry->name == name) {
-                    return entry;
-                }
+            CacheEntry<T> *found = it->second;
+            if (found->refcount <= 0) {
+                LOG_WARNING(ExInfo("extra release of a cache entry"));
+                return;
             }
-
-            return NULL;
-        }
-
-        /**
-         * Returns the matching CacheEntry or NULL.
-         */
-        CacheEntry<T> *getByValue(T value) {
-            for (unsigned int i = 0; i < m_entries.size(); i++) {
-                CacheEntry<T> *entry = m_entries[i];
-                if (entry->value == value) {
-                    return entry;
-                }
+            found->refcount -= 1;
+            if (found->refcount == 0) {
+                m_unused.push_front(found);
+                found->unusedPos = m_unused.begin();
+                evictOverBudget();
             }
-
-            return NULL;
         }
 
+        unsigned int getSize() const { return m_size; }
+        unsigned int getHits() const { return m_hits; }
+        unsigned int getMisses() const { return m_misses; }
+        unsigned int getEvictions() const { return m_evictions; }
+
+    private:
         /**
-         * Returns a next unused CacheEntry or NULL when all entries are full.
+         * Unloads least recently used entries until size fits budget.
+         * Referenced entries are never unloaded.
          */
-        CacheEntry<T>* findNextUnusedEntry() {
-            for (unsigned int attempt = 0; attempt < m_entries.size(); attempt++) {
-                CacheEntry<T> *entry = m_entries[m_next_pos];
-                m_next_pos = (m_next_pos + 1) % m_entries.size();
-
-                if (entry->refcount <= 0) {
-                    return entry;
-                }
-            }
+        void evictOverBudget() {
+            while (m_size > m_budget && !m_unused.empty()) {
+                CacheEntry<T> *entry = m_unused.back();
+                m_unused.pop_back();
+                m_names.erase(entry->name);
+                m_values.erase(entry->value);
+                m_size -= entry->size;
+                m_evictions++;
 
-            return NULL;
+                m_unloader->unloadRes(entry->value);
+                delete entry;
+            }
         }
 };
 
 #endif
-
@@ -93,17 +93,18 @@ ResDialogPack::findDialogHard(const std::string &name)
 //-----------------------------------------------------------------
 /**
  * Try find dialog for lang=speech or default lang.
+ * @param warn whether to log missing speech
  * @return dialog or NULL
  */
     const Dialog *
-ResDialogPack::findDialogSpeech(const std::string &name)
+ResDialogPack::findDialogSpeech(const std::string &name, bool warn)
 {
     std::string speech = OptionAgent::agent()->getParam("speech",
             OptionAgent::agent()->getParam("lang"));
     const Dialog *dialog = findDialog(name, speech);
     if (NULL == dialog || dialog->isSpeechless()) {
         dialog = findDialog(name, Dialog::DEFAULT_LANG);
-        if (NULL == dialog) {
+        if (NULL == dialog && warn) {
             LOG_WARNING(ExInfo("cannot find speech")
                     .addInfo("name", name)
                     .addInfo("speech", speech)
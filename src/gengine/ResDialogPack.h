@@ -20,7 +20,8 @@ class ResDialogPack : public ResourcePack<Dialog*> {
     public:
         virtual const char *getName() const { return "dialog_pack"; }
         const Dialog *findDialogHard(const std::string &name);
-        const Dialog *findDialogSpeech(const std::string &name);
+        const Dialog *findDialogSpeech(const std::string &name,
+                bool warn=true);
         virtual void unloadRes(Dialog *res);
 };
 
@@ -9,6 +9,10 @@
 #include "ResImagePack.h"
 
 #include "Path.h"
+#include "FsPath.h"
+#include "ImageAtlas.h"
+#include "ImagePrefetch.h"
+#include "AssetPack.h"
 #include "ImgException.h"
 #include "SDLException.h"
 #include "OptionAgent.h"
@@ -16,10 +20,15 @@
 
 #include "SDL_image.h"
 
-// The set cache size allows to contain all fish images and animations
-// from level 'barrel'.
+#include <stdio.h>
+
+// Unused images are kept until they fill the budget,
+// fish images are shared by all levels.
 ResCache<SDL_Surface*> *ResImagePack::CACHE = new ResCache<SDL_Surface*>(
-        265, new ResImagePack(false));
+        CACHE_BYTES, new ResImagePack(false));
+bool ResImagePack::ms_recording = false;
+ResImagePack::t_names ResImagePack::ms_recorded;
+ResImagePack::t_lists ResImagePack::ms_lists;
 
 //-----------------------------------------------------------------
 ResImagePack::ResImagePack(bool caching_enabled) {
@@ -33,6 +42,7 @@ ResImagePack::ResImagePack(bool caching_enabled) {
 /**
  * Load unshared image from file
  * and convert image to diplayformat.
+ * Pre-decoded image from asset pack is used when available.
  *
  * @return loaded surface
  * @throws ImgException when image cannot be loaded
@@ -41,20 +51,162 @@ ResImagePack::ResImagePack(bool caching_enabled) {
 SDL_Surface *
 ResImagePack::loadImage(const Path &file)
 {
+    SDL_Surface *packed = AssetPack::loadImage(file);
+    if (packed) {
+        return packed;
+    }
+
     SDL_Surface *raw_image = IMG_Load(file.getNative().c_str());
     if (NULL == raw_image) {
         throw ImgException(ExInfo("Load")
                 .addInfo("file", file.getNative()));
     }
 
-    SDL_Surface *surface = SDL_DisplayFormatAlpha(raw_image);
+    return convertImage(raw_image, file.getNative());
+}
+//-----------------------------------------------------------------
+/**
+ * Convert decoded image to diplayformat.
+ * The raw image is freed.
+ *
+ * @param raw decoded image
+ * @param file file name for error messages
+ * @return converted surface
+ * @throws SDLException when image cannot be converted
+ */
+SDL_Surface *
+ResImagePack::convertImage(SDL_Surface *raw, const std::string &file)
+{
+    SDL_Surface *surface = SDL_DisplayFormatAlpha(raw);
+    SDL_FreeSurface(raw);
     if (NULL == surface) {
         throw SDLException(ExInfo("DisplayFormat")
-                .addInfo("file", file.getNative()));
+                .addInfo("file", file));
+    }
+
+    return optimizeAlpha(surface);
+}
+//-----------------------------------------------------------------
+/**
+ * Drop per-pixel alpha when it is not really used.
+ * Images with only opaque and fully transparent pixels
+ * are converted to RLE encoded colorkey surfaces,
+ * fully opaque images are converted to plain displayformat.
+ *
+ * @param surface displayformat surface with alpha
+ * @return the given surface or a new one, the given one is freed then
+ * @throws SDLException when image cannot be converted
+ */
+SDL_Surface *
+ResImagePack::optimizeAlpha(SDL_Surface *surface)
+{
+    //NOTE: colorkey must stay unique after conversion
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    if (NULL == screen || surface->format->BytesPerPixel != 4
+            || screen->format->Rloss || screen->format->Gloss
+            || screen->format->Bloss)
+    {
+        return surface;
+    }
+
+    SDL_Color key;
+    bool transparent;
+    if (!findColorKey(surface, &key, &transparent)) {
+        return surface;
+    }
+
+    SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
+    SDL_Surface *result = SDL_DisplayFormat(surface);
+    SDL_FreeSurface(surface);
+    if (NULL == result) {
+        throw SDLException(ExInfo("DisplayFormat"));
+    }
+    if (transparent) {
+        SDL_SetColorKey(result, SDL_SRCCOLORKEY | SDL_RLEACCEL,
+                SDL_MapRGB(result->format, key.r, key.g, key.b));
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Find color unused by opaque pixels
+ * and use it for fully transparent pixels.
+ *
+ * @param surface 32bit surface with alpha
+ * @param key place to store the colorkey
+ * @param transparent place to store whether any pixel is transparent
+ * @return false when image has partial alpha or no free colorkey
+ * @throws SDLException when surface cannot be locked
+ */
+bool
+ResImagePack::findColorKey(SDL_Surface *surface, SDL_Color *key,
+        bool *transparent)
+{
+    static const SDL_Color CANDIDATES[] = {
+        {255, 0, 255, 0}, {0, 255, 255, 0}, {255, 255, 0, 0}, {1, 2, 3, 0}
+    };
+    static const int COUNT = sizeof(CANDIDATES) / sizeof(CANDIDATES[0]);
+
+    SDL_PixelFormat *fmt = surface->format;
+    if (0 == fmt->Amask) {
+        return false;
+    }
+    Uint32 candidates[COUNT];
+    for (int i = 0; i < COUNT; ++i) {
+        candidates[i] = SDL_MapRGB(fmt, CANDIDATES[i].r, CANDIDATES[i].g,
+                CANDIDATES[i].b) & ~fmt->Amask;
+    }
+
+    if (SDL_LockSurface(surface) < 0) {
+        throw SDLException(ExInfo("LockSurface"));
+    }
+    bool used[COUNT] = {false};
+    bool partial = false;
+    *transparent = false;
+    for (int y = 0; y < surface->h && !partial; ++y) {
+        Uint32 *row = reinterpret_cast<Uint32*>(
+                static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < surface->w; ++x) {
+            Uint32 alpha = row[x] & fmt->Amask;
+            if (alpha == 0) {
+                *transparent = true;
+            }
+            else if (alpha != fmt->Amask) {
+                partial = true;
+                break;
+            }
+            else {
+                Uint32 rgb = row[x] & ~fmt->Amask;
+                for (int i = 0; i < COUNT; ++i) {
+                    used[i] = used[i] || rgb == candidates[i];
+                }
+            }
+        }
     }
-    SDL_FreeSurface(raw_image);
 
-    return surface;
+    int found = -1;
+    for (int i = 0; i < COUNT && found < 0 && !partial; ++i) {
+        if (!used[i]) {
+            found = i;
+        }
+    }
+    if (found >= 0 && *transparent) {
+        for (int y = 0; y < surface->h; ++y) {
+            Uint32 *row = reinterpret_cast<Uint32*>(
+                    static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+            for (int x = 0; x < surface->w; ++x) {
+                if ((row[x] & fmt->Amask) == 0) {
+                    row[x] = candidates[found];
+                }
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+
+    if (found >= 0) {
+        *key = CANDIDATES[found];
+    }
+    return found >= 0;
 }
 //-----------------------------------------------------------------
 /**
@@ -68,10 +220,15 @@ ResImagePack::addImage(const std::string &name, const Path &file)
 {
     SDL_Surface *surface;
     if (m_caching_enabled) {
-        surface = CACHE->get(file.getPosixName());
+        std::string key = file.getPosixName();
+        if (ms_recording) {
+            ms_recorded.push_back(key);
+        }
+        surface = CACHE->get(key);
         if (!surface) {
-            surface = loadImage(file);
-            CACHE->put(file.getPosixName(), surface);
+            SDL_Surface *raw = ImagePrefetch::takeDecoded(key);
+            surface = raw ? convertImage(raw, key) : loadImage(file);
+            CACHE->put(key, surface);
         }
     } else {
         surface = loadImage(file);
@@ -83,6 +240,12 @@ ResImagePack::addImage(const std::string &name, const Path &file)
 void
 ResImagePack::unloadRes(SDL_Surface *res)
 {
+    m_trims.erase(res);
+    t_untrimmed::iterator it = m_untrimmed.find(res);
+    if (it != m_untrimmed.end()) {
+        SDL_FreeSurface(it->second);
+        m_untrimmed.erase(it);
+    }
     if (m_caching_enabled) {
         CACHE->release(res);
     } else {
@@ -90,3 +253,274 @@ ResImagePack::unloadRes(SDL_Surface *res)
     }
 }
 
+//-----------------------------------------------------------------
+/**
+ * Return size of surface pixels.
+ */
+unsigned int
+ResImagePack::getResSize(SDL_Surface *res) const
+{
+    return sizeof(SDL_Surface) + res->h * res->pitch;
+}
+//-----------------------------------------------------------------
+void
+ResImagePack::logCacheStats()
+{
+    LOG_INFO(ExInfo("image cache")
+            .addInfo("hits", CACHE->getHits())
+            .addInfo("misses", CACHE->getMisses())
+            .addInfo("evictions", CACHE->getEvictions())
+            .addInfo("bytes", CACHE->getSize()));
+}
+//-----------------------------------------------------------------
+/**
+ * Start noting names of all cached images.
+ */
+void
+ResImagePack::recordStart()
+{
+    ms_recording = true;
+    ms_recorded.clear();
+}
+//-----------------------------------------------------------------
+/**
+ * Stop noting images, nothing is stored.
+ */
+void
+ResImagePack::recordCancel()
+{
+    ms_recording = false;
+    ms_recorded.clear();
+}
+//-----------------------------------------------------------------
+/**
+ * Store noted images as a prefetch list.
+ * The list is used by next prefetchList() with the same name.
+ * Nothing is written when the list has not changed,
+ * e.g. after restart of the level.
+ */
+void
+ResImagePack::recordStop(const std::string &listname)
+{
+    ms_recording = false;
+    t_names recorded;
+    recorded.swap(ms_recorded);
+    if (recorded.empty()) {
+        return;
+    }
+
+    t_names known;
+    if (readList(listname, &known) && known == recorded) {
+        return;
+    }
+    writeList(listname, recorded);
+}
+//-----------------------------------------------------------------
+/**
+ * Let images from the named list be decoded on background.
+ * Images already in cache are skipped.
+ * Level without a list gets images from "images/<listname>" directory.
+ */
+void
+ResImagePack::prefetchList(const std::string &listname)
+{
+    t_names names;
+    if (!readList(listname, &names)) {
+        listImages(Path::dataReadPath("images/" + listname).getPosixName(),
+                &names);
+    }
+
+    std::vector<std::string> files;
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        if (!CACHE->has(names[i]) && !AssetPack::isPacked(names[i])) {
+            files.push_back(names[i]);
+        }
+    }
+    ImagePrefetch::request(files);
+}
+//-----------------------------------------------------------------
+/**
+ * Read prefetch list, the file is read only once.
+ * @return false when there is no list
+ */
+bool
+ResImagePack::readList(const std::string &listname, t_names *names)
+{
+    t_lists::iterator it = ms_lists.find(listname);
+    if (it != ms_lists.end()) {
+        *names = it->second;
+        return true;
+    }
+
+    Path file = Path::dataReadPath("prefetch/" + listname + ".lst");
+    FILE *listFile = fopen(file.getNative().c_str(), "r");
+    if (NULL == listFile) {
+        return false;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), listFile)) {
+        std::string name = line;
+        std::string::size_type end = name.find_last_not_of("\r\n");
+        if (end != std::string::npos) {
+            name.erase(end + 1);
+            names->push_back(name);
+        }
+    }
+    fclose(listFile);
+    ms_lists[listname] = *names;
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Write prefetch list to a temp file and rename it.
+ */
+void
+ResImagePack::writeList(const std::string &listname, const t_names &names)
+{
+    //NOTE: path must exist before rename
+    std::string file = Path::dataWritePath(
+            "prefetch/" + listname + ".lst").getNative();
+    std::string temp = file + ".tmp";
+    FILE *listFile = fopen(temp.c_str(), "w");
+    bool result = (NULL != listFile);
+    for (unsigned int i = 0; result && i < names.size(); ++i) {
+        result = fputs(names[i].c_str(), listFile) >= 0
+            && fputc('\n', listFile) != EOF;
+    }
+    if (listFile) {
+        result = (0 == fclose(listFile)) && result;
+    }
+#ifdef WIN32
+    if (result) {
+        remove(file.c_str());
+    }
+#endif
+    result = result && 0 == rename(temp.c_str(), file.c_str());
+    if (result) {
+        ms_lists[listname] = names;
+    }
+    else {
+        remove(temp.c_str());
+        LOG_WARNING(ExInfo("cannot save prefetch list")
+                .addInfo("file", file));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Add all PNG images from the directory and its subdirectories.
+ */
+void
+ResImagePack::listImages(const std::string &dir, t_names *names)
+{
+    static const std::string SUFFIX = ".png";
+    std::vector<std::string> files;
+    std::vector<std::string> dirs;
+    FsPath::listDir(dir, &files, &dirs);
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        const std::string &name = files[i];
+        if (name.size() > SUFFIX.size() && name.compare(
+                    name.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) == 0)
+        {
+            names->push_back(FsPath::join(dir, name));
+        }
+    }
+    for (unsigned int i = 0; i < dirs.size(); ++i) {
+        listImages(FsPath::join(dir, dirs[i]), names);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Convert prefetched images and put them to cache.
+ * Conversion has limited time per call,
+ * it should be called every frame from the main thread.
+ */
+void
+ResImagePack::warmCache()
+{
+    Uint32 start = SDL_GetTicks();
+    std::string file;
+    SDL_Surface *raw;
+    while (SDL_GetTicks() - start < WARM_MS
+            && (raw = ImagePrefetch::takeDone(&file)) != NULL)
+    {
+        if (CACHE->has(file)) {
+            SDL_FreeSurface(raw);
+            continue;
+        }
+        try {
+            SDL_Surface *surface = convertImage(raw, file);
+            CACHE->put(file, surface);
+            CACHE->release(surface);
+        }
+        catch (SDLException &e) {
+            LOG_WARNING(e.info());
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Add all images to the atlas.
+ */
+void
+ResImagePack::collectImages(ImageAtlas *atlas) const
+{
+    t_constIterator end = m_reses.end();
+    for (t_constIterator item = m_reses.begin(); item != end; ++item) {
+        atlas->addImage(item->second);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Replace packed images with views into the atlas.
+ * The original images are released.
+ * NOTE: the atlas must live longer than this pack.
+ *
+ * @throws SDLException when view cannot be created
+ */
+void
+ResImagePack::useAtlas(const ImageAtlas *atlas)
+{
+    t_resIterator end = m_reses.end();
+    for (t_resIterator item = m_reses.begin(); item != end; ++item) {
+        SDL_Rect trim;
+        SDL_Surface *view = atlas->createView(item->second, &trim);
+        if (view) {
+            unloadRes(item->second);
+            item->second = view;
+            m_trims[view] = trim;
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return offset and original size of a trimmed image
+ * or NULL for untouched image.
+ */
+const SDL_Rect *
+ResImagePack::getTrim(SDL_Surface *res) const
+{
+    if (m_trims.empty()) {
+        return NULL;
+    }
+    t_trims::const_iterator it = m_trims.find(res);
+    return it == m_trims.end() ? NULL : &(it->second);
+}
+//-----------------------------------------------------------------
+/**
+ * Return trimmed image restored to its original size.
+ * The copy is made once and kept until the image is unloaded.
+ * @throws SDLException when surface cannot be created
+ */
+SDL_Surface *
+ResImagePack::getUntrimmed(SDL_Surface *res)
+{
+    t_untrimmed::iterator it = m_untrimmed.find(res);
+    if (it != m_untrimmed.end()) {
+        return it->second;
+    }
+
+    SDL_Surface *untrimmed = ImageAtlas::createUntrimmed(res, m_trims[res]);
+    m_untrimmed[res] = untrimmed;
+    return untrimmed;
+}
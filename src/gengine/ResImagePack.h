@@ -2,26 +2,65 @@
 #define HEADER_RESIMAGEPACK_H
 
 class Path;
+class ImageAtlas;
 
 #include "ResourcePack.h"
 #include "ResCache.h"
 
 #include "SDL.h"
 
+#include <string>
+#include <vector>
+#include <map>
+
 /**
  * Image resources and image loading.
  */
 class ResImagePack : public ResourcePack<SDL_Surface*> {
     private:
+        static const unsigned int CACHE_BYTES = 48 * 1024 * 1024;
+        static const Uint32 WARM_MS = 4;
         static ResCache<SDL_Surface*> *CACHE;
+        static bool ms_recording;
+        typedef std::vector<std::string> t_names;
+        typedef std::map<std::string,t_names> t_lists;
+        static t_names ms_recorded;
+        static t_lists ms_lists;
         bool m_caching_enabled;
+        typedef std::map<SDL_Surface*,SDL_Rect> t_trims;
+        t_trims m_trims;
+        typedef std::map<SDL_Surface*,SDL_Surface*> t_untrimmed;
+        t_untrimmed m_untrimmed;
+    private:
+        static SDL_Surface *optimizeAlpha(SDL_Surface *surface);
+        static bool readList(const std::string &listname, t_names *names);
+        static void writeList(const std::string &listname,
+                const t_names &names);
+        static void listImages(const std::string &dir, t_names *names);
     public:
         explicit ResImagePack(bool caching_enabled=true);
         virtual const char *getName() const { return "image_pack"; }
 
         static SDL_Surface *loadImage(const Path &file);
+        static SDL_Surface *convertImage(SDL_Surface *raw,
+                const std::string &file);
+        static bool findColorKey(SDL_Surface *surface, SDL_Color *key,
+                bool *transparent);
         void addImage(const std::string &name, const Path &file);
         virtual void unloadRes(SDL_Surface *res);
+        virtual unsigned int getResSize(SDL_Surface *res) const;
+        static void logCacheStats();
+
+        static void recordStart();
+        static void recordStop(const std::string &listname);
+        static void recordCancel();
+        static void prefetchList(const std::string &listname);
+        static void warmCache();
+
+        void collectImages(ImageAtlas *atlas) const;
+        void useAtlas(const ImageAtlas *atlas);
+        const SDL_Rect *getTrim(SDL_Surface *res) const;
+        SDL_Surface *getUntrimmed(SDL_Surface *res);
 };
 
 #endif
@@ -10,6 +10,13 @@
 
 #include "Path.h"
 #include "OptionAgent.h"
+#include "AssetPack.h"
+#include "SpeechLoader.h"
+
+// Speech stays decoded across levels until it fills the budget.
+ResCache<Mix_Chunk*> *ResSoundPack::SPEECH_CACHE = new ResCache<Mix_Chunk*>(
+        SPEECH_BYTES, new ResSoundPack());
+unsigned int ResSoundPack::ms_waits = 0;
 
 //-----------------------------------------------------------------
     void
@@ -18,8 +25,15 @@ ResSoundPack::unloadRes(Mix_Chunk *res)
     Mix_FreeChunk(res);
 }
 //-----------------------------------------------------------------
+unsigned int
+ResSoundPack::getResSize(Mix_Chunk *res) const
+{
+    return sizeof(Mix_Chunk) + res->alen;
+}
+//-----------------------------------------------------------------
 /**
  * Load unshared sound from file.
+ * Pre-decoded sound from asset pack is used when available.
  * @return sound or NULL
  */
     Mix_Chunk *
@@ -28,7 +42,10 @@ ResSoundPack::loadSound(const Path &file)
     Mix_Chunk *chunk = NULL;
     //TODO: ask SoundAgent to load this sound
     if (OptionAgent::agent()->getAsBool("sound", true)) {
-        chunk = Mix_LoadWAV(file.getNative().c_str());
+        chunk = AssetPack::loadSound(file);
+        if (NULL == chunk) {
+            chunk = Mix_LoadWAV(file.getNative().c_str());
+        }
         if (NULL == chunk) {
             LOG_WARNING(ExInfo("cannot load sound")
                 .addInfo("path", file.getNative())
@@ -50,4 +67,98 @@ ResSoundPack::addSound(const std::string &name, const Path &file)
         addRes(name, chunk);
     }
 }
-
+//-----------------------------------------------------------------
+/**
+ * Let speech be decoded on background.
+ * Sounds already in cache or in asset pack are skipped.
+ */
+    void
+ResSoundPack::prefetchSpeech(const Path &file)
+{
+    std::string key = file.getPosixName();
+    if (!SPEECH_CACHE->has(key) && !AssetPack::isPacked(key)) {
+        SpeechLoader::request(key, file.getNative());
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Stop waiting decoding of unneeded speech.
+ */
+    void
+ResSoundPack::cancelSpeech(const Path &file)
+{
+    SpeechLoader::cancel(file.getPosixName());
+}
+//-----------------------------------------------------------------
+/**
+ * Return shared speech sound or NULL.
+ * Reports when the speech was not decoded in advance.
+ * The sound should be released via releaseSpeech().
+ */
+    Mix_Chunk *
+ResSoundPack::getSpeech(const Path &file)
+{
+    std::string key = file.getPosixName();
+    Mix_Chunk *chunk = SPEECH_CACHE->get(key);
+    if (NULL == chunk) {
+        Uint32 start = SDL_GetTicks();
+        bool waited;
+        chunk = SpeechLoader::takeDecoded(key, &waited);
+        if (NULL == chunk) {
+            chunk = loadSound(file);
+            waited = chunk && !AssetPack::isPacked(key);
+        }
+        if (waited) {
+            ms_waits++;
+            LOG_INFO(ExInfo("speech was not decoded in advance")
+                    .addInfo("file", key)
+                    .addInfo("wait_ms", SDL_GetTicks() - start));
+        }
+        if (chunk) {
+            SPEECH_CACHE->put(key, chunk);
+        }
+    }
+    return chunk;
+}
+//-----------------------------------------------------------------
+    void
+ResSoundPack::releaseSpeech(Mix_Chunk *speech)
+{
+    if (speech) {
+        SPEECH_CACHE->release(speech);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Put decoded speech to cache.
+ * It should be called every frame from the main thread.
+ */
+    void
+ResSoundPack::warmCache()
+{
+    Uint32 start = SDL_GetTicks();
+    std::string key;
+    Mix_Chunk *chunk;
+    while (SDL_GetTicks() - start < WARM_MS
+            && (chunk = SpeechLoader::takeDone(&key)) != NULL)
+    {
+        if (SPEECH_CACHE->has(key)) {
+            Mix_FreeChunk(chunk);
+        }
+        else {
+            SPEECH_CACHE->put(key, chunk);
+            SPEECH_CACHE->release(chunk);
+        }
+    }
+}
+//-----------------------------------------------------------------
+    void
+ResSoundPack::logCacheStats()
+{
+    LOG_INFO(ExInfo("speech cache")
+            .addInfo("hits", SPEECH_CACHE->getHits())
+            .addInfo("misses", SPEECH_CACHE->getMisses())
+            .addInfo("evictions", SPEECH_CACHE->getEvictions())
+            .addInfo("waits", ms_waits)
+            .addInfo("bytes", SPEECH_CACHE->getSize()));
+}
@@ -4,6 +4,7 @@
 class Path;
 
 #include "ResourcePack.h"
+#include "ResCache.h"
 
 #include "SDL_mixer.h"
 
@@ -11,13 +12,25 @@ class Path;
  * Sound resources.
  */
 class ResSoundPack : public ResourcePack<Mix_Chunk*> {
+    private:
+        static const unsigned int SPEECH_BYTES = 64 * 1024 * 1024;
+        static const Uint32 WARM_MS = 2;
+        static ResCache<Mix_Chunk*> *SPEECH_CACHE;
+        static unsigned int ms_waits;
     public:
         virtual const char *getName() const { return "sound_pack"; }
 
         static Mix_Chunk *loadSound(const Path &file);
         void addSound(const std::string &name, const Path &file);
         virtual void unloadRes(Mix_Chunk *res);
+        virtual unsigned int getResSize(Mix_Chunk *res) const;
+
+        static void prefetchSpeech(const Path &file);
+        static void cancelSpeech(const Path &file);
+        static Mix_Chunk *getSpeech(const Path &file);
+        static void releaseSpeech(Mix_Chunk *speech);
+        static void warmCache();
+        static void logCacheStats();
 };
 
 #endif
-
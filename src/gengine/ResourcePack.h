@@ -28,6 +28,11 @@ class ResourcePack : public INamed {
      * Frees the given resource.
      */
     virtual void unloadRes(T res) = 0;
+    /**
+     * Returns memory used by the given resource.
+     * Caches use it to limit their size.
+     */
+    virtual unsigned int getResSize(T /*res*/) const { return 1; }
 
     //NOTE: we cannot call virtual functions from desctructor,
     // call removeAll before delete
@@ -0,0 +1,14 @@
+#ifndef HEADER_ROWTASK_H
+#define HEADER_ROWTASK_H
+
+/**
+ * Work on a band of rows.
+ * Bands are disjoint, they can run in parallel.
+ */
+class RowTask {
+    public:
+        virtual ~RowTask() {}
+        virtual void runRows(int begin, int end) = 0;
+};
+
+#endif
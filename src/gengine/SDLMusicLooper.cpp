@@ -11,16 +11,41 @@
 #include "Path.h"
 #include "StringTool.h"
 #include "Log.h"
+#include "MusicStream.h"
+#include "OptionAgent.h"
+#include "SDLException.h"
+#include "minmax.h"
 
 #include <string.h> //memset
 
 //-----------------------------------------------------------------
 /**
  * Initialize the player for a specific piece of music.
+ * Streamed music is decoded on background,
+ * so this does not block.
  */
     SDLMusicLooper::SDLMusicLooper(const Path &file)
 : m_volume(MIX_MAX_VOLUME), m_position(0)
 {
+    m_music = NULL;
+    m_stream = NULL;
+    m_startLoop = 0;
+    m_endLoop = 0;
+#ifdef HAVE_VORBISFILE
+    if (OptionAgent::agent()->getAsBool("stream_music", true)) {
+        long start = 0;
+        long end = -1;
+        readLoopPoints(file.getNative() + ".meta", &start, &end);
+        try {
+            m_stream = new MusicStream(file.getNative(), start, end);
+            return;
+        }
+        catch (SDLException &e) {
+            LOG_WARNING(e.info());
+        }
+    }
+#endif
+
     Uint16 fmt;
     int freq, channels;
     Mix_QuerySpec(&freq, &fmt, &channels);
@@ -40,6 +65,9 @@
 SDLMusicLooper::~SDLMusicLooper()
 {
     stop();
+    if (m_stream) {
+        delete m_stream;
+    }
     if (m_music) {
         Mix_FreeChunk(m_music);
     }
@@ -60,7 +88,7 @@ SDLMusicLooper::setVolume(int volume)
 void
 SDLMusicLooper::start()
 {
-    if (m_music) {
+    if (m_music || m_stream) {
         Mix_HookMusic(musicOutput, (void*)this);
     }
 }
@@ -89,35 +117,55 @@ SDLMusicLooper::lookupLoopData(const Path &file, int multiplier)
     m_startLoop = 0;
     m_endLoop = m_music->alen;
 
-    std::string metafile = file.getNative() + ".meta";
+    long start;
+    long end;
+    if (!readLoopPoints(file.getNative() + ".meta", &start, &end)) {
+        return;
+    }
+
+    m_startLoop = start * multiplier;
+    m_endLoop = end * multiplier;
+    if ((unsigned int)m_endLoop > m_music->alen) {
+        m_endLoop = m_music->alen;
+    }
+    LOG_DEBUG(ExInfo("looping music")
+            .addInfo("start", m_startLoop / multiplier)
+            .addInfo("end", m_endLoop / multiplier));
+}
+//-----------------------------------------------------------------
+/**
+ * Read loop points in samples at 22050 Hz.
+ * @return false when there is no usable meta file
+ */
+bool
+SDLMusicLooper::readLoopPoints(const std::string &metafile,
+        long *start, long *end)
+{
     char buffer[1024];
     memset(buffer, 0, sizeof(buffer));
     FILE *meta = fopen(metafile.c_str(), "r");
     if(!meta) {
-        return;
+        return false;
     }
 
-    if (!fread(&buffer, 1, sizeof(buffer) - 1, meta)) {
+    size_t count = fread(&buffer, 1, sizeof(buffer) - 1, meta);
+    fclose(meta);
+    if (!count) {
         LOG_WARNING(ExInfo("unable to read music meta data")
                 .addInfo("file", metafile));
-        return;
+        return false;
     }
 
     StringTool::t_args lines = StringTool::split(buffer, '\n');
     if (lines.size() < 2) {
         LOG_WARNING(ExInfo("unrecognized music meta data format")
                 .addInfo("file", metafile));
-        return;
+        return false;
     }
 
-    m_startLoop = strtol(lines[0].c_str(), NULL, 10) * multiplier;
-    m_endLoop = strtol(lines[1].c_str(), NULL, 10) * multiplier;
-    if ((unsigned int)m_endLoop > m_music->alen) {
-        m_endLoop = m_music->alen;
-    }
-    LOG_DEBUG(ExInfo("looping music")
-            .addInfo("start", m_startLoop / multiplier)
-            .addInfo("end", m_endLoop / multiplier));
+    *start = strtol(lines[0].c_str(), NULL, 10);
+    *end = strtol(lines[1].c_str(), NULL, 10);
+    return true;
 }
 //-----------------------------------------------------------------
 /**
@@ -130,6 +178,19 @@ SDLMusicLooper::musicOutput(void *udata, Uint8 *stream, int length)
     int n;
 
     memset(stream, 0, length);
+    if (that->m_stream) {
+        while (length > 0) {
+            n = that->m_stream->read(that->m_buffer,
+                    min(length, BUFFER_BYTES));
+            if (n == 0) {
+                break;
+            }
+            SDL_MixAudio(stream, that->m_buffer, n, that->m_volume);
+            stream += n;
+            length -= n;
+        }
+        return;
+    }
     while (length >= that->m_endLoop - that->m_position) {
         n = that->m_endLoop - that->m_position;
         SDL_MixAudio(stream, that->m_music->abuf + that->m_position, n,
@@ -2,23 +2,33 @@
 #define HEADER_SDLMUSICLOOPER_H
 
 class Path;
+class MusicStream;
 
 #include "SDL.h"
 #include "SDL_mixer.h"
 
+#include <string>
+
 /**
  * Playing music in a loop.
+ * Ogg music is streamed when vorbisfile is available,
+ * otherwise the whole music is decoded in memory.
  */
 class SDLMusicLooper {
     private:
+    static const int BUFFER_BYTES = 4096;
     int m_volume;
     int m_position;
 
     Mix_Chunk *m_music;
     int m_startLoop, m_endLoop;
+    MusicStream *m_stream;
+    Uint8 m_buffer[BUFFER_BYTES];
 
     private:
         void lookupLoopData(const Path &file, int multiplier);
+        static bool readLoopPoints(const std::string &metafile,
+                long *start, long *end);
         static void musicOutput(void *udata, Uint8 *stream, int length);
 
     public:
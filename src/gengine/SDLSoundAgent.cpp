@@ -16,6 +16,8 @@
 #include "Random.h"
 #include "BaseMsg.h"
 #include "OptionAgent.h"
+#include "ResSoundPack.h"
+#include "SpeechLoader.h"
 
 BaseMsg *SDLSoundAgent::ms_finished = NULL;
 //-----------------------------------------------------------------
@@ -28,11 +30,22 @@ BaseMsg *SDLSoundAgent::ms_finished = NULL;
 SDLSoundAgent::own_init()
 {
     SoundAgent::own_init();
+    SpeechLoader::init();
+}
+//-----------------------------------------------------------------
+/**
+ * Take speech decoded on background.
+ */
+    void
+SDLSoundAgent::own_update()
+{
+    ResSoundPack::warmCache();
 }
 //-----------------------------------------------------------------
     void
 SDLSoundAgent::own_shutdown()
 {
+    SpeechLoader::shutdown();
     stopMusic();
     Mix_CloseAudio();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
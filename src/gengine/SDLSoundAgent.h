@@ -27,6 +27,7 @@ class SDLSoundAgent : public SoundAgent {
         static void musicFinished();
     protected:
         virtual void own_init();
+        virtual void own_update();
         virtual void own_shutdown();
         virtual void reinit();
 
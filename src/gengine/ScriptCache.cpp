@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ScriptCache.h"
+
+#include "Log.h"
+#include "Path.h"
+#include "FsPath.h"
+#include "AssetPack.h"
+#include "DataIndex.h"
+#include "OptionAgent.h"
+#include "StringTool.h"
+#include "PathException.h"
+
+extern "C" {
+#include "lauxlib.h"
+}
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------
+/**
+ * Load script file as a function on the stack.
+ * Fresh cached bytecode is used when available,
+ * otherwise the source is compiled and the cache is rebuilt.
+ * @return luaL_loadfile status
+ */
+int
+ScriptCache::loadFile(lua_State *L, const Path &file)
+{
+    std::string key;
+    if (isCacheable(file)) {
+        key = getKey(file);
+    }
+    if (key.empty()) {
+        return luaL_loadfile(L, file.getNative().c_str());
+    }
+
+    Path cache = getCachePath(file);
+    if (loadCached(L, cache, key)) {
+        return 0;
+    }
+
+    int error = luaL_loadfile(L, file.getNative().c_str());
+    if (0 == error) {
+        storeCached(L, cache, key);
+    }
+    return error;
+}
+//-----------------------------------------------------------------
+/**
+ * Only scripts under systemdir are cached.
+ * Their mtime changes only by installing new data.
+ */
+bool
+ScriptCache::isCacheable(const Path &file)
+{
+    OptionAgent *options = OptionAgent::agent();
+    std::string userdir = options->getParam("userdir");
+    std::string name = file.getPosixName();
+    return !userdir.empty()
+        && options->getAsBool("cache_scripts", true)
+        && DataIndex::isUnder(name, options->getParam("systemdir"))
+        && !DataIndex::isUnder(name, userdir);
+}
+//-----------------------------------------------------------------
+/**
+ * Key is the first line of a cache file.
+ * @return key or empty string when the script cannot be stat'ed
+ */
+std::string
+ScriptCache::getKey(const Path &file)
+{
+    Uint32 mtime;
+    Uint32 size;
+    if (!AssetPack::statFile(file.getPosixName(), &mtime, &size)) {
+        return "";
+    }
+    return std::string(LUA_VERSION) + " " + StringTool::toString(mtime)
+        + " " + StringTool::toString(size) + " " + file.getNative() + "\n";
+}
+//-----------------------------------------------------------------
+/**
+ * Cache file is named by FNV-1a hash of the script path.
+ */
+Path
+ScriptCache::getCachePath(const Path &file)
+{
+    static const char HEX[] = "0123456789abcdef";
+    std::string name = file.getNative();
+    Uint32 hash = 2166136261u;
+    for (std::string::size_type i = 0; i < name.size(); ++i) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 16777619u;
+    }
+
+    std::string hex;
+    for (int i = 7; i >= 0; --i) {
+        hex.push_back(HEX[(hash >> (4 * i)) & 0xf]);
+    }
+    return Path::dataUserPath("cache/lua/" + hex + ".luac");
+}
+//-----------------------------------------------------------------
+/**
+ * Load cached bytecode when its key matches.
+ * @return true when the chunk is on the stack
+ */
+bool
+ScriptCache::loadCached(lua_State *L, const Path &cache,
+        const std::string &key)
+{
+    FILE *input = fopen(cache.getNative().c_str(), "rb");
+    if (NULL == input) {
+        return false;
+    }
+
+    std::string data;
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+        data.append(buffer, got);
+    }
+    fclose(input);
+
+    if (data.size() <= key.size() || data.compare(0, key.size(), key) != 0) {
+        return false;
+    }
+    if (luaL_loadbuffer(L, data.data() + key.size(), data.size() - key.size(),
+                cache.getNative().c_str()) != 0)
+    {
+        LOG_WARNING(ExInfo("invalid cached script")
+                .addInfo("cache", cache.getNative())
+                .addInfo("error", lua_tostring(L, -1)));
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Dump compiled chunk from the stack top.
+ * The cache is written to a temp file and renamed.
+ */
+void
+ScriptCache::storeCached(lua_State *L, const Path &cache,
+        const std::string &key)
+{
+    std::string data = key;
+    lua_dump(L, writeChunk, &data);
+
+    std::string file = cache.getNative();
+    std::string temp = file + ".tmp";
+    FILE *output = NULL;
+    try {
+        FsPath::createPath(cache.getPosixName());
+        output = fopen(temp.c_str(), "wb");
+    }
+    catch (PathException &e) {
+        LOG_WARNING(e.info());
+    }
+    if (NULL == output) {
+        return;
+    }
+
+    bool result = fwrite(data.data(), 1, data.size(), output) == data.size();
+    result = (0 == fclose(output)) && result;
+#ifdef WIN32
+    if (result) {
+        remove(file.c_str());
+    }
+#endif
+    result = result && 0 == rename(temp.c_str(), file.c_str());
+    if (result) {
+        DataIndex::noteFile(cache.getPosixName());
+    }
+    else {
+        remove(temp.c_str());
+        LOG_WARNING(ExInfo("cannot cache script")
+                .addInfo("cache", file));
+    }
+}
+//-----------------------------------------------------------------
+int
+ScriptCache::writeChunk(lua_State * /*L*/, const void *data, size_t size,
+        void *output)
+{
+    static_cast<std::string*>(output)->append(
+            static_cast<const char*>(data), size);
+    return 0;
+}
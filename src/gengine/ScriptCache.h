@@ -0,0 +1,34 @@
+#ifndef HEADER_SCRIPTCACHE_H
+#define HEADER_SCRIPTCACHE_H
+
+#include "NoCopy.h"
+#include "Path.h"
+
+#include <string>
+
+extern "C" {
+#include "lua.h"
+}
+
+/**
+ * Precompiled scripts in "cache/lua" under userdir.
+ * A cache file is keyed by script path, mtime, size and Lua version.
+ * Only game scripts from systemdir are cached,
+ * files written by the game (saves, solutions, options) are not.
+ */
+class ScriptCache : public NoCopy {
+    private:
+        static bool isCacheable(const Path &file);
+        static std::string getKey(const Path &file);
+        static Path getCachePath(const Path &file);
+        static bool loadCached(lua_State *L, const Path &cache,
+                const std::string &key);
+        static void storeCached(lua_State *L, const Path &cache,
+                const std::string &key);
+        static int writeChunk(lua_State *L, const void *data, size_t size,
+                void *output);
+    public:
+        static int loadFile(lua_State *L, const Path &file);
+};
+
+#endif
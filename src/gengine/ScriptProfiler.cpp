@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ScriptProfiler.h"
+
+#include "Log.h"
+#include "Path.h"
+#include "FsPath.h"
+#include "DataIndex.h"
+#include "PathException.h"
+
+#include "SDL.h"
+
+#include <stdio.h>
+#include <algorithm>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+ScriptProfiler::t_profilers ScriptProfiler::ms_profilers;
+
+//-----------------------------------------------------------------
+/**
+ * Attach hooks to the state.
+ */
+ScriptProfiler::ScriptProfiler(lua_State *L)
+{
+    m_state = L;
+    ms_profilers[L] = this;
+    lua_sethook(L, hook, LUA_MASKCALL | LUA_MASKRET | LUA_MASKCOUNT,
+            SAMPLE_COUNT);
+}
+//-----------------------------------------------------------------
+ScriptProfiler::~ScriptProfiler()
+{
+    lua_sethook(m_state, NULL, 0, 0);
+    ms_profilers.erase(m_state);
+}
+//-----------------------------------------------------------------
+void
+ScriptProfiler::hook(lua_State *L, lua_Debug *ar)
+{
+    t_profilers::iterator it = ms_profilers.find(L);
+    if (it == ms_profilers.end()) {
+        return;
+    }
+
+    ScriptProfiler *profiler = it->second;
+    switch (ar->event) {
+        case LUA_HOOKCALL:
+            profiler->enter(getKey(L, ar));
+            break;
+        case LUA_HOOKRET:
+        case LUA_HOOKTAILRET:
+            profiler->leave();
+            break;
+        case LUA_HOOKCOUNT:
+            profiler->sample();
+            break;
+        default:
+            break;
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return time in microseconds.
+ */
+double
+ScriptProfiler::now()
+{
+#ifdef WIN32
+    return SDL_GetTicks() * 1000.0;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * C bindings are named "[C] name",
+ * Lua functions "name source:line".
+ */
+std::string
+ScriptProfiler::getKey(lua_State *L, lua_Debug *ar)
+{
+    lua_getinfo(L, "nS", ar);
+    std::string name = ar->name ? ar->name : "?";
+    if (ar->what && 'C' == ar->what[0]) {
+        return "[C] " + name;
+    }
+
+    char line[16];
+    snprintf(line, sizeof(line), ":%d", ar->linedefined);
+    return name + " " + ar->short_src + line;
+}
+//-----------------------------------------------------------------
+void
+ScriptProfiler::enter(const std::string &key)
+{
+    Frame frame;
+    frame.stats = &m_stats[key];
+    frame.stats->calls++;
+    frame.stats->active++;
+    frame.children = 0;
+    frame.start = now();
+    m_stack.push_back(frame);
+}
+//-----------------------------------------------------------------
+/**
+ * Recursive calls count only once into inclusive time.
+ */
+void
+ScriptProfiler::leave()
+{
+    if (m_stack.empty()) {
+        return;
+    }
+
+    Frame frame = m_stack.back();
+    m_stack.pop_back();
+    double elapsed = now() - frame.start;
+    frame.stats->exclusive += elapsed - frame.children;
+    frame.stats->active--;
+    if (0 == frame.stats->active) {
+        frame.stats->inclusive += elapsed;
+    }
+    if (!m_stack.empty()) {
+        m_stack.back().children += elapsed;
+    }
+}
+//-----------------------------------------------------------------
+void
+ScriptProfiler::sample()
+{
+    if (!m_stack.empty()) {
+        m_stack.back().stats->samples++;
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Close frames left by a failed call.
+ */
+void
+ScriptProfiler::unwind(int depth)
+{
+    while (getDepth() > depth) {
+        leave();
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return table sorted by exclusive time.
+ * @param lines max number of functions, 0 for all
+ */
+std::string
+ScriptProfiler::getReport(unsigned int lines) const
+{
+    //NOTE: negative time sorts the slowest first
+    std::vector<std::pair<double,std::string> > order;
+    t_stats::const_iterator end = m_stats.end();
+    for (t_stats::const_iterator i = m_stats.begin(); i != end; ++i) {
+        order.push_back(std::make_pair(-i->second.exclusive, i->first));
+    }
+    std::sort(order.begin(), order.end());
+    if (lines > 0 && order.size() > lines) {
+        order.resize(lines);
+    }
+
+    std::string report = "   calls   incl_ms   excl_ms samples function\n";
+    char buffer[64];
+    for (unsigned int i = 0; i < order.size(); ++i) {
+        const Stats &stats = m_stats.find(order[i].second)->second;
+        snprintf(buffer, sizeof(buffer), "%8d %9.2f %9.2f %7d ",
+                stats.calls, stats.inclusive / 1000.0,
+                stats.exclusive / 1000.0, stats.samples);
+        report += buffer + order[i].second + "\n";
+    }
+    return report;
+}
+//-----------------------------------------------------------------
+/**
+ * Write full report to "profile/<name>.txt" under userdir.
+ */
+void
+ScriptProfiler::writeReport(const std::string &name) const
+{
+    Path file = Path::dataUserPath("profile/" + name + ".txt");
+    FILE *output = NULL;
+    try {
+        FsPath::createPath(file.getPosixName());
+        output = fopen(file.getNative().c_str(), "w");
+    }
+    catch (PathException &e) {
+        LOG_WARNING(e.info());
+    }
+    if (NULL == output) {
+        LOG_WARNING(ExInfo("cannot write script profile")
+                .addInfo("file", file.getNative()));
+        return;
+    }
+
+    fputs(getReport().c_str(), output);
+    fclose(output);
+    DataIndex::noteFile(file.getPosixName());
+    LOG_INFO(ExInfo("script profile")
+            .addInfo("file", file.getNative()));
+}
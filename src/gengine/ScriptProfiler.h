@@ -0,0 +1,59 @@
+#ifndef HEADER_SCRIPTPROFILER_H
+#define HEADER_SCRIPTPROFILER_H
+
+#include "NoCopy.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+extern "C" {
+#include "lua.h"
+}
+
+/**
+ * Lua profiler driven by call, return and count hooks.
+ * Inclusive and exclusive time is measured per Lua function
+ * and per C binding, count hook samples the running function.
+ */
+class ScriptProfiler : public NoCopy {
+    private:
+        static const int SAMPLE_COUNT = 1000;
+        struct Stats {
+            int calls;
+            int active;
+            int samples;
+            double inclusive;
+            double exclusive;
+            Stats() : calls(0), active(0), samples(0),
+                inclusive(0), exclusive(0) {}
+        };
+        struct Frame {
+            Stats *stats;
+            double start;
+            double children;
+        };
+        typedef std::map<std::string,Stats> t_stats;
+        typedef std::map<lua_State*,ScriptProfiler*> t_profilers;
+        static t_profilers ms_profilers;
+        lua_State *m_state;
+        t_stats m_stats;
+        std::vector<Frame> m_stack;
+    private:
+        static void hook(lua_State *L, lua_Debug *ar);
+        static double now();
+        static std::string getKey(lua_State *L, lua_Debug *ar);
+        void enter(const std::string &key);
+        void leave();
+        void sample();
+    public:
+        explicit ScriptProfiler(lua_State *L);
+        ~ScriptProfiler();
+
+        int getDepth() const { return m_stack.size(); }
+        void unwind(int depth);
+        std::string getReport(unsigned int lines=0) const;
+        void writeReport(const std::string &name) const;
+};
+
+#endif
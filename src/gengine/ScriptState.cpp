@@ -11,6 +11,8 @@
 #include "Log.h"
 #include "Path.h"
 #include "ScriptException.h"
+#include "ScriptCache.h"
+#include "ScriptProfiler.h"
 
 extern "C" {
 #include "lualib.h"
@@ -19,9 +21,17 @@ extern "C" {
 
 #include "def-script.h"
 
+#include "SDL.h"
+
+ScriptState::t_states ScriptState::ms_states;
+int ScriptState::ms_gcCollections = 0;
+int ScriptState::ms_gcForced = 0;
+unsigned int ScriptState::ms_gcTotalPause = 0;
+unsigned int ScriptState::ms_gcMaxPause = 0;
 //-----------------------------------------------------------------
 ScriptState::ScriptState()
 {
+    m_profiler = NULL;
     m_state = lua_open();
     luaopen_base(m_state);
     luaopen_string(m_state);
@@ -29,10 +39,18 @@ ScriptState::ScriptState()
     luaopen_table(m_state);
 
     prepareErrorHandler();
+    m_gcLastCount = getGcCount();
+    m_gcLive = m_gcLastCount;
+    m_gcFrameAlloc = 0;
+    m_gcLastPause = 0;
+    ms_states.push_back(this);
 }
 //-----------------------------------------------------------------
 ScriptState::~ScriptState()
 {
+    ms_states.remove(this);
+    forgetGlobals();
+    delete m_profiler;
     lua_close(m_state);
 }
 //-----------------------------------------------------------------
@@ -71,9 +89,13 @@ ScriptState::callStack(int error, int params, int returns)
 {
     if (0 == error) {
         int base = lua_gettop(m_state) - params;
+        int depth = m_profiler ? m_profiler->getDepth() : 0;
         insertErrorHandler(base);
         error = lua_pcall(m_state, params, returns, base);
         lua_remove(m_state, base);
+        if (error && m_profiler) {
+            m_profiler->unwind(depth);
+        }
     }
 
     if (error) {
@@ -88,14 +110,92 @@ ScriptState::callStack(int error, int params, int returns)
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Push global function resolved through registry.
+ * The function is looked up only first time after any script change.
+ * @throws ScriptException when there is no such function
+ */
+void
+ScriptState::pushGlobal(const char *name)
+{
+    t_refs::iterator it = m_globalRefs.find(name);
+    if (it == m_globalRefs.end()) {
+        lua_pushstring(m_state, name);
+        lua_rawget(m_state, LUA_GLOBALSINDEX);
+        if (!lua_isfunction(m_state, -1)) {
+            lua_pop(m_state, 1);
+            throw ScriptException(ExInfo("script function not found")
+                    .addInfo("name", name));
+        }
+        int funcRef = luaL_ref(m_state, LUA_REGISTRYINDEX);
+        it = m_globalRefs.insert(std::make_pair(std::string(name),
+                    funcRef)).first;
+    }
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, it->second);
+}
+//-----------------------------------------------------------------
+/**
+ * Release resolved functions.
+ * Scripts can redefine them.
+ */
+void
+ScriptState::forgetGlobals()
+{
+    t_refs::iterator end = m_globalRefs.end();
+    for (t_refs::iterator i = m_globalRefs.begin(); i != end; ++i) {
+        unref(i->second);
+    }
+    m_globalRefs.clear();
+}
+//-----------------------------------------------------------------
+/**
+ * Call "function()".
+ * @param name global function name
+ * @throws ScriptException when function is bad
+ */
+void
+ScriptState::callGlobal(const char *name)
+{
+    pushGlobal(name);
+    callStack(0);
+}
+//-----------------------------------------------------------------
+/**
+ * Call "function(text, flag)".
+ */
+void
+ScriptState::callGlobal(const char *name, const std::string &text,
+        bool flag)
+{
+    pushGlobal(name);
+    lua_pushlstring(m_state, text.c_str(), text.size());
+    lua_pushboolean(m_state, flag);
+    callStack(0, 2);
+}
+//-----------------------------------------------------------------
+/**
+ * Call "function(text, number)".
+ */
+void
+ScriptState::callGlobal(const char *name, const std::string &text,
+        int number)
+{
+    pushGlobal(name);
+    lua_pushlstring(m_state, text.c_str(), text.size());
+    lua_pushnumber(m_state, number);
+    callStack(0, 2);
+}
+//-----------------------------------------------------------------
 /**
  * Process script file.
+ * Precompiled script from cache is used when it is fresh.
  * @param file script
  */
     void
 ScriptState::doFile(const Path &file)
 {
-    int error = luaL_loadfile(m_state, file.getNative().c_str());
+    forgetGlobals();
+    int error = ScriptCache::loadFile(m_state, file);
     callStack(error);
 }
 //-----------------------------------------------------------------
@@ -106,6 +206,7 @@ ScriptState::doFile(const Path &file)
     void
 ScriptState::doString(const std::string &input)
 {
+    forgetGlobals();
     int error = luaL_loadbuffer(m_state, input.c_str(), input.size(),
             input.c_str());
     callStack(error);
@@ -166,4 +267,194 @@ ScriptState::registerLeader(Scripter *leader)
     lua_pushlightuserdata(m_state, leader);
     lua_rawset(m_state, LUA_REGISTRYINDEX);
 }
+//-----------------------------------------------------------------
+/**
+ * Start measuring time spent in script functions.
+ */
+void
+ScriptState::startProfiler()
+{
+    if (NULL == m_profiler) {
+        m_profiler = new ScriptProfiler(m_state);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return KB in use.
+ */
+int
+ScriptState::getGcCount() const
+{
+#if LUA_VERSION_NUM >= 501
+    return lua_gc(m_state, LUA_GCCOUNT, 0);
+#else
+    return lua_getgccount(m_state);
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * Keep automatic collection away while the game is playing.
+ * Lua 5.0 collects when the threshold is reached,
+ * newer Lua is stopped and collected only by us.
+ * @param headroom KB which can be allocated before collection
+ */
+void
+ScriptState::postponeGc(int headroom)
+{
+#if LUA_VERSION_NUM >= 501
+    lua_gc(m_state, LUA_GCSTOP, 0);
+#else
+    lua_setgcthreshold(m_state, getGcCount() + headroom);
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * Run full collection.
+ * @return pause in ms
+ */
+unsigned int
+ScriptState::collectGarbage()
+{
+    Uint32 start = SDL_GetTicks();
+#if LUA_VERSION_NUM >= 501
+    lua_gc(m_state, LUA_GCCOLLECT, 0);
+#else
+    lua_setgcthreshold(m_state, 0);
+#endif
+    unsigned int pause = SDL_GetTicks() - start;
+
+    int count = getGcCount();
+    LOG_DEBUG(ExInfo("script gc")
+            .addInfo("freed_kb", m_gcLastCount - count)
+            .addInfo("pause_ms", pause));
+    m_gcLastCount = count;
+    m_gcLive = count;
+    m_gcLastPause = pause;
+
+    ms_gcCollections++;
+    ms_gcTotalPause += pause;
+    if (pause > ms_gcMaxPause) {
+        ms_gcMaxPause = pause;
+    }
+    return pause;
+}
+//-----------------------------------------------------------------
+/**
+ * Collect in small steps until the budget is used
+ * or the collection cycle is finished.
+ * Lua 5.0 has only full collection,
+ * it is done when the last one fits into the budget.
+ * @param budget idle ms left in this frame
+ * @return used ms
+ */
+unsigned int
+ScriptState::stepGarbage(unsigned int budget)
+{
+#if LUA_VERSION_NUM >= 501
+    Uint32 start = SDL_GetTicks();
+    unsigned int used = 0;
+    bool finished = false;
+    while (!finished && used < budget) {
+        finished = (1 == lua_gc(m_state, LUA_GCSTEP, GC_STEP_KB));
+        used = SDL_GetTicks() - start;
+    }
 
+    int count = getGcCount();
+    if (finished) {
+        LOG_DEBUG(ExInfo("script gc cycle")
+                .addInfo("live_kb", count));
+        m_gcLive = count;
+        ms_gcCollections++;
+    }
+    m_gcLastCount = count;
+
+    ms_gcTotalPause += used;
+    if (used > ms_gcMaxPause) {
+        ms_gcMaxPause = used;
+    }
+    return used;
+#else
+    return budget > m_gcLastPause ? collectGarbage() : 0;
+#endif
+}
+//-----------------------------------------------------------------
+/**
+ * Measure allocation in the last frame,
+ * collect when there is garbage and time.
+ * Too much garbage is collected even without time.
+ * @param budget idle ms left in this frame
+ * @return used ms
+ */
+unsigned int
+ScriptState::scheduleGc(unsigned int budget)
+{
+    int count = getGcCount();
+    int alloc = count - m_gcLastCount;
+    if (alloc > 0) {
+        m_gcFrameAlloc = (7 * m_gcFrameAlloc + alloc) / 8;
+    }
+    if (count < m_gcLive) {
+        //NOTE: Lua has collected itself
+        m_gcLive = count;
+    }
+    m_gcLastCount = count;
+
+    unsigned int used = 0;
+    int garbage = count - m_gcLive;
+    if (garbage >= GC_MAX_HEADROOM) {
+        ms_gcForced++;
+        used = collectGarbage();
+    }
+    else if (garbage >= GC_MIN_GARBAGE && budget > 0) {
+        used = stepGarbage(budget);
+    }
+
+    int headroom = m_gcFrameAlloc * GC_HEADROOM_FRAMES;
+    if (headroom < GC_MIN_HEADROOM) {
+        headroom = GC_MIN_HEADROOM;
+    }
+    else if (headroom > GC_MAX_HEADROOM) {
+        headroom = GC_MAX_HEADROOM;
+    }
+    postponeGc(headroom);
+    return used;
+}
+//-----------------------------------------------------------------
+/**
+ * Use idle time of this frame for script garbage collection.
+ * Should be called once per frame.
+ * @param budget ms until the next frame
+ */
+void
+ScriptState::collectIdle(unsigned int budget)
+{
+    t_states::iterator end = ms_states.end();
+    for (t_states::iterator i = ms_states.begin(); i != end; ++i) {
+        unsigned int used = (*i)->scheduleGc(budget);
+        budget = used < budget ? budget - used : 0;
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Collect all scripts.
+ * Used at level transitions where a pause is not visible.
+ */
+void
+ScriptState::collectAll()
+{
+    t_states::iterator end = ms_states.end();
+    for (t_states::iterator i = ms_states.begin(); i != end; ++i) {
+        (*i)->collectGarbage();
+        (*i)->postponeGc(GC_MIN_HEADROOM);
+    }
+}
+//-----------------------------------------------------------------
+void
+ScriptState::logGcStats()
+{
+    LOG_INFO(ExInfo("script gc stats")
+            .addInfo("collections", ms_gcCollections)
+            .addInfo("forced", ms_gcForced)
+            .addInfo("total_pause_ms", ms_gcTotalPause)
+            .addInfo("max_pause_ms", ms_gcMaxPause));
+}
@@ -3,10 +3,13 @@
 
 class Path;
 class Scripter;
+class ScriptProfiler;
 
 #include "NoCopy.h"
 
 #include <string>
+#include <map>
+#include <list>
 
 extern "C" {
 #include "lua.h"
@@ -17,12 +20,37 @@ extern "C" {
  */
 class ScriptState : public NoCopy {
     private:
+        static const int GC_MIN_GARBAGE = 64;
+        static const int GC_MIN_HEADROOM = 512;
+        static const int GC_MAX_HEADROOM = 8192;
+        static const int GC_HEADROOM_FRAMES = 600;
+        static const int GC_STEP_KB = 16;
+        typedef std::map<std::string,int> t_refs;
+        typedef std::list<ScriptState*> t_states;
+        static t_states ms_states;
+        static int ms_gcCollections;
+        static int ms_gcForced;
+        static unsigned int ms_gcTotalPause;
+        static unsigned int ms_gcMaxPause;
         lua_State *m_state;
         int m_errorHandlerIndex;
+        t_refs m_globalRefs;
+        ScriptProfiler *m_profiler;
+        int m_gcLastCount;
+        int m_gcLive;
+        int m_gcFrameAlloc;
+        unsigned int m_gcLastPause;
     private:
         void prepareErrorHandler();
         void insertErrorHandler(int index);
         void callStack(int error, int params=0, int returns=0);
+        void pushGlobal(const char *name);
+        void forgetGlobals();
+        int getGcCount() const;
+        void postponeGc(int headroom);
+        unsigned int collectGarbage();
+        unsigned int stepGarbage(unsigned int budget);
+        unsigned int scheduleGc(unsigned int budget);
     public:
         ScriptState();
         ~ScriptState();
@@ -32,8 +60,19 @@ class ScriptState : public NoCopy {
         bool callCommand(int funcRef, int param);
         void unref(int funcRef);
 
+        void callGlobal(const char *name);
+        void callGlobal(const char *name, const std::string &text, bool flag);
+        void callGlobal(const char *name, const std::string &text, int number);
+
         void registerFunc(const char *name, lua_CFunction func);
         void registerLeader(Scripter *leader);
+
+        void startProfiler();
+        ScriptProfiler *getProfiler() const { return m_profiler; }
+
+        static void collectIdle(unsigned int budget);
+        static void collectAll();
+        static void logGcStats();
 };
 
 #endif
@@ -27,6 +27,15 @@ Scripter::~Scripter()
     delete m_script;
 }
 //-----------------------------------------------------------------
+/**
+ * Return script profiler or NULL when it is not running.
+ */
+    ScriptProfiler *
+Scripter::getProfiler() const
+{
+    return m_script->getProfiler();
+}
+//-----------------------------------------------------------------
 /**
  * Include this script file.
  */
@@ -44,4 +53,24 @@ Scripter::scriptDo(const std::string &input)
 {
     m_script->doString(input);
 }
-
+//-----------------------------------------------------------------
+/**
+ * Call global script function.
+ */
+    void
+Scripter::scriptCall(const char *name)
+{
+    m_script->callGlobal(name);
+}
+//-----------------------------------------------------------------
+    void
+Scripter::scriptCall(const char *name, const std::string &text, bool flag)
+{
+    m_script->callGlobal(name, text, flag);
+}
+//-----------------------------------------------------------------
+    void
+Scripter::scriptCall(const char *name, const std::string &text, int number)
+{
+    m_script->callGlobal(name, text, number);
+}
@@ -3,6 +3,7 @@
 
 class Path;
 class ScriptState;
+class ScriptProfiler;
 
 #include "NoCopy.h"
 
@@ -18,8 +19,14 @@ class Scripter : public NoCopy {
         Scripter();
         virtual ~Scripter();
 
+        ScriptProfiler *getProfiler() const;
+
         void scriptInclude(const Path &filename);
         void scriptDo(const std::string &input);
+        void scriptCall(const char *name);
+        void scriptCall(const char *name, const std::string &text, bool flag);
+        void scriptCall(const char *name, const std::string &text,
+                int number);
 };
 
 #endif
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "SpeechLoader.h"
+
+#include "Log.h"
+#include "SDLException.h"
+
+SpeechLoader *SpeechLoader::ms_loader = NULL;
+
+//-----------------------------------------------------------------
+/**
+ * Start decoder thread.
+ * @throws SDLException when thread cannot be created
+ */
+SpeechLoader::SpeechLoader()
+{
+    m_quit = false;
+    m_mutex = SDL_CreateMutex();
+    m_wake = SDL_CreateCond();
+    m_finished = SDL_CreateCond();
+    if (NULL == m_mutex || NULL == m_wake || NULL == m_finished) {
+        throw SDLException(ExInfo("CreateMutex"));
+    }
+
+    m_thread = SDL_CreateThread(decoderMain, this);
+    if (NULL == m_thread) {
+        throw SDLException(ExInfo("CreateThread"));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Stop decoder and free unused sounds.
+ */
+SpeechLoader::~SpeechLoader()
+{
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    m_queue.clear();
+    SDL_CondSignal(m_wake);
+    SDL_UnlockMutex(m_mutex);
+    SDL_WaitThread(m_thread, NULL);
+
+    t_items::iterator end = m_done.end();
+    for (t_items::iterator i = m_done.begin(); i != end; ++i) {
+        Mix_FreeChunk(i->chunk);
+    }
+    SDL_DestroyCond(m_finished);
+    SDL_DestroyCond(m_wake);
+    SDL_DestroyMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Create shared decoder.
+ * NOTE: mixer must be opened before
+ */
+void
+SpeechLoader::init()
+{
+    if (NULL == ms_loader) {
+        try {
+            ms_loader = new SpeechLoader();
+        }
+        catch (SDLException &e) {
+            LOG_WARNING(e.info());
+        }
+    }
+}
+//-----------------------------------------------------------------
+void
+SpeechLoader::shutdown()
+{
+    delete ms_loader;
+    ms_loader = NULL;
+}
+//-----------------------------------------------------------------
+int
+SpeechLoader::decoderMain(void *loader)
+{
+    static_cast<SpeechLoader*>(loader)->work();
+    return 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Decode queued sounds one by one.
+ */
+void
+SpeechLoader::work()
+{
+    SDL_LockMutex(m_mutex);
+    while (true) {
+        while (!m_quit && m_queue.empty()) {
+            SDL_CondWait(m_wake, m_mutex);
+        }
+        if (m_quit) {
+            break;
+        }
+        Item item = m_queue.front();
+        m_queue.pop_front();
+        m_current = item.key;
+        SDL_UnlockMutex(m_mutex);
+
+        item.chunk = Mix_LoadWAV(item.file.c_str());
+
+        SDL_LockMutex(m_mutex);
+        if (item.chunk) {
+            m_done.push_back(item);
+        }
+        else {
+            LOG_DEBUG(ExInfo("cannot decode speech")
+                    .addInfo("file", item.file));
+        }
+        m_current = "";
+        SDL_CondBroadcast(m_finished);
+    }
+    SDL_UnlockMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Return true when the sound is queued, decoded or being decoded.
+ * NOTE: mutex must be locked
+ */
+bool
+SpeechLoader::isKnown(const std::string &key) const
+{
+    if (key == m_current) {
+        return true;
+    }
+    t_items::const_iterator queueEnd = m_queue.end();
+    for (t_items::const_iterator i = m_queue.begin(); i != queueEnd; ++i) {
+        if (i->key == key) {
+            return true;
+        }
+    }
+    t_items::const_iterator doneEnd = m_done.end();
+    for (t_items::const_iterator i = m_done.begin(); i != doneEnd; ++i) {
+        if (i->key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+//-----------------------------------------------------------------
+/**
+ * Remove all items with the given key.
+ * NOTE: mutex must be locked
+ */
+void
+SpeechLoader::removeKey(t_items &items, const std::string &key)
+{
+    t_items::iterator i = items.begin();
+    while (i != items.end()) {
+        if (i->key == key) {
+            i = items.erase(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Queue sound for decoding.
+ * @param key name used to take the sound
+ * @param file native filename
+ */
+void
+SpeechLoader::request(const std::string &key, const std::string &file)
+{
+    if (NULL == ms_loader) {
+        return;
+    }
+
+    SDL_LockMutex(ms_loader->m_mutex);
+    if (!ms_loader->isKnown(key)) {
+        Item item;
+        item.key = key;
+        item.file = file;
+        item.chunk = NULL;
+        ms_loader->m_queue.push_back(item);
+        SDL_CondSignal(ms_loader->m_wake);
+    }
+    SDL_UnlockMutex(ms_loader->m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Remove waiting sound from queue.
+ */
+void
+SpeechLoader::cancel(const std::string &key)
+{
+    if (NULL == ms_loader) {
+        return;
+    }
+
+    SDL_LockMutex(ms_loader->m_mutex);
+    removeKey(ms_loader->m_queue, key);
+    SDL_UnlockMutex(ms_loader->m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Take any decoded sound.
+ * @param key place to store key of the sound
+ * @return chunk or NULL when nothing is decoded
+ */
+Mix_Chunk *
+SpeechLoader::takeDone(std::string *key)
+{
+    if (NULL == ms_loader) {
+        return NULL;
+    }
+
+    Mix_Chunk *result = NULL;
+    SDL_LockMutex(ms_loader->m_mutex);
+    if (!ms_loader->m_done.empty()) {
+        *key = ms_loader->m_done.front().key;
+        result = ms_loader->m_done.front().chunk;
+        ms_loader->m_done.pop_front();
+    }
+    SDL_UnlockMutex(ms_loader->m_mutex);
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Take decoded sound.
+ * Waits when the sound is just being decoded.
+ * A waiting sound is removed from queue, caller will load it itself.
+ *
+ * @param waited place to store whether decoding was waited for
+ * @return chunk or NULL
+ */
+Mix_Chunk *
+SpeechLoader::takeDecoded(const std::string &key, bool *waited)
+{
+    *waited = false;
+    if (NULL == ms_loader) {
+        return NULL;
+    }
+
+    SDL_LockMutex(ms_loader->m_mutex);
+    removeKey(ms_loader->m_queue, key);
+    while (key == ms_loader->m_current) {
+        *waited = true;
+        SDL_CondWait(ms_loader->m_finished, ms_loader->m_mutex);
+    }
+
+    Mix_Chunk *result = NULL;
+    t_items &done = ms_loader->m_done;
+    for (t_items::iterator i = done.begin(); i != done.end(); ++i) {
+        if (i->key == key) {
+            result = i->chunk;
+            done.erase(i);
+            break;
+        }
+    }
+    SDL_UnlockMutex(ms_loader->m_mutex);
+    return result;
+}
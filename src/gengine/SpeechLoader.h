@@ -0,0 +1,50 @@
+#ifndef HEADER_SPEECHLOADER_H
+#define HEADER_SPEECHLOADER_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+#include "SDL_mixer.h"
+
+#include <string>
+#include <list>
+
+/**
+ * Background thread decoding dialog sounds.
+ * Sounds are decoded in request order.
+ */
+class SpeechLoader : public NoCopy {
+    private:
+        struct Item {
+            std::string key;
+            std::string file;
+            Mix_Chunk *chunk;
+        };
+        typedef std::list<Item> t_items;
+        static SpeechLoader *ms_loader;
+        t_items m_queue;
+        t_items m_done;
+        std::string m_current;
+        SDL_Thread *m_thread;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_wake;
+        SDL_cond *m_finished;
+        bool m_quit;
+    private:
+        SpeechLoader();
+        static int decoderMain(void *loader);
+        void work();
+        bool isKnown(const std::string &key) const;
+        static void removeKey(t_items &items, const std::string &key);
+    public:
+        ~SpeechLoader();
+        static void init();
+        static void shutdown();
+
+        static void request(const std::string &key, const std::string &file);
+        static void cancel(const std::string &key);
+        static Mix_Chunk *takeDone(std::string *key);
+        static Mix_Chunk *takeDecoded(const std::string &key, bool *waited);
+};
+
+#endif
@@ -9,20 +9,34 @@
 #include "TimerAgent.h"
 
 #include "OptionAgent.h"
+#include "ScriptState.h"
+#include "Log.h"
+#include "minmax.h"
 
 //-----------------------------------------------------------------
     void
 TimerAgent::own_init()
 {
     m_timeinterval = OptionAgent::agent()->getAsInt("timeinterval", 100);
+    m_frameinterval = OptionAgent::agent()->getAsInt("frameinterval", 16);
     m_lastTime = SDL_GetTicks();
     m_nextTime = m_lastTime;
+    m_nextFrame = m_lastTime;
     m_deltaTime = 1;
     m_count = 0;
+    m_tick = true;
+    m_benchmark = OptionAgent::agent()->getAsBool("benchmark", false);
+    m_scriptGc = OptionAgent::agent()->getAsBool("script_gc", true);
+    m_startTime = m_lastTime;
+    if (m_benchmark) {
+        m_lastTime = 0;
+        m_frameinterval = 0;
+    }
 }
 //-----------------------------------------------------------------
 /**
  * Game is faster with pressed Shift.
+ * NOTE: benchmark mode ignores Shift to stay deterministic
  */
 int
 TimerAgent::getTimeInterval()
@@ -36,22 +50,91 @@ TimerAgent::getTimeInterval()
 }
 //-----------------------------------------------------------------
 /**
- * Sleep fixed number miliseconds.
+ * Sleep until next frame or next tick.
+ * Without frameinterval every cycle is a tick.
+ * Script garbage is collected in the time we would sleep.
  */
     void
 TimerAgent::own_update()
 {
-    m_count++;
+    if (m_benchmark) {
+        m_count++;
+        m_deltaTime = m_timeinterval;
+        m_lastTime += m_timeinterval;
+        if (m_scriptGc) {
+            //NOTE: no idle time, only the forced collection is done
+            ScriptState::collectIdle(0);
+        }
+        return;
+    }
+
+    Uint32 wakeTime = m_nextTime;
+    if (m_frameinterval > 0 && m_nextFrame < wakeTime) {
+        wakeTime = m_nextFrame;
+    }
 
     Uint32 now = SDL_GetTicks();
-    if (now < m_nextTime) {
-        SDL_Delay(m_nextTime - now);
+    if (m_scriptGc) {
+        ScriptState::collectIdle(now < wakeTime ? wakeTime - now : 0);
+        now = SDL_GetTicks();
+    }
+    if (now < wakeTime) {
+        SDL_Delay(wakeTime - now);
     }
 
     now = SDL_GetTicks();
-    //NOTE: every cycle have fixed time interval
-    m_nextTime = now + getTimeInterval();
+    m_nextFrame = now + m_frameinterval;
+    m_tick = (now >= m_nextTime);
+    if (m_tick) {
+        m_count++;
+        //NOTE: every cycle have fixed time interval
+        m_nextTime = now + getTimeInterval();
 
-    m_deltaTime = now - m_lastTime;
-    m_lastTime = now;
+        m_deltaTime = now - m_lastTime;
+        m_lastTime = now;
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Report benchmark speed.
+ */
+    void
+TimerAgent::own_shutdown()
+{
+    if (m_benchmark) {
+        Uint32 wallTime = max(1u, SDL_GetTicks() - m_startTime);
+        LOG_INFO(ExInfo("benchmark")
+                .addInfo("cycles", m_count)
+                .addInfo("wall_ms", wallTime)
+                .addInfo("cycles_per_sec",
+                    static_cast<long>(1000.0 * m_count / wallTime)));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return how far is the time between the last and the next tick.
+ * Frames drawn between ticks use it to interpolate.
+ * @return 0.0 just after a tick, 1.0 when next tick is due
+ */
+float
+TimerAgent::getTickFraction() const
+{
+    if (m_frameinterval <= 0 || m_nextTime <= m_lastTime) {
+        return 1.0;
+    }
+
+    Uint32 now = SDL_GetTicks();
+    if (now >= m_nextTime) {
+        return 1.0;
+    }
+    return static_cast<float>(now - m_lastTime) / (m_nextTime - m_lastTime);
+}
+//-----------------------------------------------------------------
+/**
+ * Return cycles interpolated between the previous and the last tick.
+ */
+float
+TimerAgent::getSmoothCycles() const
+{
+    return m_count - 1 + getTickFraction();
 }
@@ -8,23 +8,38 @@
 
 /**
  * Delay and framerame.
+ * The simulation runs in fixed ticks,
+ * rendering can run more often and interpolate between ticks.
+ *
+ * Benchmark mode never sleeps, a virtual clock advances
+ * by exactly timeinterval every cycle.
  */
 class TimerAgent : public BaseAgent {
     AGENT(TimerAgent, Name::TIMER_NAME);
     private:
         int m_timeinterval;
+        int m_frameinterval;
         Uint32 m_lastTime;
         Uint32 m_nextTime;
+        Uint32 m_nextFrame;
         Uint32 m_deltaTime;
         int m_count;
+        bool m_tick;
+        bool m_benchmark;
+        bool m_scriptGc;
+        Uint32 m_startTime;
     private:
         int getTimeInterval();
     protected:
         virtual void own_init();
         virtual void own_update();
+        virtual void own_shutdown();
     public:
         Uint32 getDeltaTime() const { return m_deltaTime; }
         int getCycles() const { return m_count; }
+        bool isTick() const { return m_tick; }
+        float getTickFraction() const;
+        float getSmoothCycles() const;
 };
 
 #endif
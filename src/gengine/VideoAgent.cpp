@@ -18,10 +18,57 @@
 #include "StringMsg.h"
 #include "UnknownMsgException.h"
 #include "OptionAgent.h"
+#include "TimerAgent.h"
 #include "SysVideo.h"
+#include "WorkerPool.h"
+#include "ImagePrefetch.h"
+#include "ResImagePack.h"
+#include "FrameDump.h"
+#include "FrameCapture.h"
+#include "RowTask.h"
+#include "minmax.h"
 
 #include "SDL_image.h"
 #include <stdlib.h> // atexit()
+#include <string.h>
+
+namespace {
+/**
+ * Copy backbuffer rows enlarged by integer scale.
+ */
+class ScaleRows : public RowTask {
+    private:
+        SDL_Surface *m_src;
+        SDL_Surface *m_dest;
+        int m_scale;
+        int m_x;
+        int m_y;
+    public:
+        ScaleRows(SDL_Surface *src, SDL_Surface *dest, int scale,
+                int x, int y)
+            : m_src(src), m_dest(dest), m_scale(scale), m_x(x), m_y(y) {}
+        virtual void runRows(int begin, int end)
+        {
+            int bpp = m_src->format->BytesPerPixel;
+            int rowSize = m_src->w * m_scale * bpp;
+            for (int sy = begin; sy < end; ++sy) {
+                Uint8 *s = static_cast<Uint8*>(m_src->pixels)
+                    + sy * m_src->pitch;
+                Uint8 *first = static_cast<Uint8*>(m_dest->pixels)
+                    + (m_y + sy * m_scale) * m_dest->pitch + m_x * bpp;
+                Uint8 *d = first;
+                for (int sx = 0; sx < m_src->w; ++sx, s += bpp) {
+                    for (int k = 0; k < m_scale; ++k, d += bpp) {
+                        memcpy(d, s, bpp);
+                    }
+                }
+                for (int k = 1; k < m_scale; ++k) {
+                    memcpy(first + k * m_dest->pitch, first, rowSize);
+                }
+            }
+        }
+};
+}
 
 //-----------------------------------------------------------------
 /**
@@ -33,7 +80,21 @@
 VideoAgent::own_init()
 {
     m_screen = NULL;
+    m_display = NULL;
     m_fullscreen = false;
+    m_fixedScreen = OptionAgent::agent()->getAsBool("fixed_screen", false);
+    m_integerScale = OptionAgent::agent()->getAsBool("fixed_scale", true);
+    m_clearDisplay = false;
+    m_scale = 1;
+    m_offsetX = 0;
+    m_offsetY = 0;
+    m_dump = NULL;
+    m_capture = NULL;
+    m_offscreen = OptionAgent::agent()->getAsBool("offscreen", false);
+    if (m_offscreen) {
+        static char driver[] = "SDL_VIDEODRIVER=dummy";
+        SDL_putenv(driver);
+    }
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         throw SDLException(ExInfo("Init"));
     }
@@ -42,7 +103,12 @@ VideoAgent::own_init()
     setIcon(Path::dataReadPath("images/icon.png"));
 
     registerWatcher("fullscreen");
+    registerWatcher("fixed_scale");
     initVideoMode();
+    initFrameDump();
+    initCapture();
+    WorkerPool::init();
+    ImagePrefetch::init();
 }
 //-----------------------------------------------------------------
 /**
@@ -52,8 +118,18 @@ VideoAgent::own_init()
     void
 VideoAgent::own_update()
 {
+    ResImagePack::warmCache();
     drawOn(m_screen);
-    SDL_Flip(m_screen);
+    if (m_dump) {
+        m_dump->noteFrame(m_screen);
+    }
+    if (m_capture && TimerAgent::agent()->isTick()) {
+        m_capture->pushFrame(m_screen);
+    }
+    if (m_screen != m_display) {
+        presentBackBuffer();
+    }
+    SDL_Flip(m_display);
 }
 //-----------------------------------------------------------------
 /**
@@ -62,6 +138,15 @@ VideoAgent::own_update()
     void
 VideoAgent::own_shutdown()
 {
+    delete m_dump;
+    m_dump = NULL;
+    delete m_capture;
+    m_capture = NULL;
+    ImagePrefetch::shutdown();
+    WorkerPool::shutdown();
+    if (m_screen != m_display) {
+        SDL_FreeSurface(m_screen);
+    }
     SDL_Quit();
 }
 
@@ -83,10 +168,47 @@ VideoAgent::setIcon(const Path &file)
     SDL_FreeSurface(icon);
 }
 
+//-----------------------------------------------------------------
+/**
+ * Prepare frame dump when "dump_frame" or "dump_every" is set.
+ */
+    void
+VideoAgent::initFrameDump()
+{
+    OptionAgent *options = OptionAgent::agent();
+    int dumpFrame = options->getAsInt("dump_frame", 0);
+    int dumpEvery = options->getAsInt("dump_every", 0);
+    if (dumpFrame > 0 || dumpEvery > 0) {
+        m_dump = new FrameDump(dumpFrame, dumpEvery,
+                options->getParam("dump_prefix", "frame"),
+                options->getParam("dump_format", "ppm"));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Start frame capture when "capture" path is set.
+ * The first frame drawn after every tick is captured,
+ * so the video has one frame per "timeinterval" of game time
+ * also when more frames are drawn between ticks.
+ */
+    void
+VideoAgent::initCapture()
+{
+    OptionAgent *options = OptionAgent::agent();
+    std::string path = options->getParam("capture");
+    if (!path.empty()) {
+        int interval = options->getAsInt("timeinterval", 100);
+        int fps = options->getAsInt("capture_fps",
+                interval > 0 ? 1000 / interval : 10);
+        m_capture = new FrameCapture(path,
+                options->getParam("capture_format", "ppm"), fps);
+    }
+}
 //-----------------------------------------------------------------
 /**
  * Init video mode along options.
  * Change window only when necessary.
+ * In fixed screen mode only the backbuffer is changed.
  *
  * @throws SDLException when video mode cannot be made,
  * the old video mode remain usable
@@ -99,7 +221,14 @@ VideoAgent::initVideoMode()
     int screen_height = options->getAsInt("screen_height", 480);
 
     SysVideo::setCaption(options->getParam("caption", "A game"));
-    if (NULL == m_screen
+    if (m_fixedScreen) {
+        if (NULL == m_display) {
+            changeVideoMode(options->getAsInt("fixed_width", 1024),
+                    options->getAsInt("fixed_height", 768));
+        }
+        changeBackBuffer(screen_width, screen_height);
+    }
+    else if (NULL == m_screen
             || m_screen->w != screen_width
             || m_screen->h != screen_height)
     {
@@ -107,9 +236,112 @@ VideoAgent::initVideoMode()
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Create backbuffer with the display format.
+ * @throws SDLException when backbuffer cannot be made
+ */
+    void
+VideoAgent::changeBackBuffer(int screen_width, int screen_height)
+{
+    if (m_screen && m_screen != m_display
+            && m_screen->w == screen_width && m_screen->h == screen_height) {
+        return;
+    }
+
+    SDL_PixelFormat *fmt = m_display->format;
+    SDL_Surface *buffer = SDL_CreateRGBSurface(SDL_SWSURFACE,
+            screen_width, screen_height, fmt->BitsPerPixel,
+            fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+    if (NULL == buffer) {
+        throw SDLException(ExInfo("CreateRGBSurface")
+                .addInfo("width", screen_width)
+                .addInfo("height", screen_height));
+    }
+    if (m_screen && m_screen != m_display) {
+        SDL_FreeSurface(m_screen);
+    }
+    m_screen = buffer;
+    if (screen_width > m_display->w || screen_height > m_display->h) {
+        LOG_WARNING(ExInfo("backbuffer is bigger than screen")
+                .addInfo("width", screen_width)
+                .addInfo("height", screen_height));
+    }
+    updateLayout();
+}
+//-----------------------------------------------------------------
+/**
+ * Compute scale and position of the backbuffer on display.
+ */
+    void
+VideoAgent::updateLayout()
+{
+    m_scale = 1;
+    if (m_integerScale) {
+        m_scale = max(1, min(m_display->w / m_screen->w,
+                    m_display->h / m_screen->h));
+    }
+    m_offsetX = (m_display->w - m_screen->w * m_scale) / 2;
+    m_offsetY = (m_display->h - m_screen->h * m_scale) / 2;
+    m_clearDisplay = true;
+}
+//-----------------------------------------------------------------
+/**
+ * Put backbuffer on display, borders are black.
+ */
+    void
+VideoAgent::presentBackBuffer()
+{
+    if (m_clearDisplay) {
+        SDL_FillRect(m_display, NULL, 0);
+        m_clearDisplay = false;
+    }
+
+    if (m_scale == 1) {
+        SDL_Rect rect;
+        rect.x = m_offsetX;
+        rect.y = m_offsetY;
+        SDL_BlitSurface(m_screen, NULL, m_display, &rect);
+    }
+    else {
+        if (SDL_MUSTLOCK(m_display) && SDL_LockSurface(m_display) < 0) {
+            throw SDLException(ExInfo("LockSurface"));
+        }
+        ScaleRows task(m_screen, m_display, m_scale, m_offsetX, m_offsetY);
+        WorkerPool::forRows(&task, m_screen->h,
+                m_display->w * m_display->h);
+        if (SDL_MUSTLOCK(m_display)) {
+            SDL_UnlockSurface(m_display);
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Translate window location to location on the drawn screen.
+ * @return screen location or (-1, -1) for border around backbuffer
+ */
+    V2
+VideoAgent::toScreenLoc(const V2 &displayLoc) const
+{
+    if (m_screen == m_display) {
+        return displayLoc;
+    }
+
+    int x = displayLoc.getX() - m_offsetX;
+    int y = displayLoc.getY() - m_offsetY;
+    if (x < 0 || y < 0) {
+        return V2(-1, -1);
+    }
+    x /= m_scale;
+    y /= m_scale;
+    if (x >= m_screen->w || y >= m_screen->h) {
+        return V2(-1, -1);
+    }
+    return V2(x, y);
+}
+//-----------------------------------------------------------------
 /**
  * Init new video mode.
- * NOTE: m_screen pointer will change
+ * NOTE: m_display and m_screen pointers will change
  */
     void
 VideoAgent::changeVideoMode(int screen_width, int screen_height)
@@ -117,7 +349,7 @@ VideoAgent::changeVideoMode(int screen_width, int screen_height)
     OptionAgent *options = OptionAgent::agent();
     int screen_bpp = options->getAsInt("screen_bpp", 32);
     int videoFlags = getVideoFlags();
-    m_fullscreen = options->getAsBool("fullscreen", false);
+    m_fullscreen = !m_offscreen && options->getAsBool("fullscreen", false);
     if (m_fullscreen) {
         videoFlags |= SDL_FULLSCREEN;
     }
@@ -137,7 +369,13 @@ VideoAgent::changeVideoMode(int screen_width, int screen_height)
     }
 
     if (newScreen) {
-        m_screen = newScreen;
+        m_display = newScreen;
+        if (m_fixedScreen && m_screen) {
+            updateLayout();
+        }
+        else if (!m_fixedScreen) {
+            m_screen = newScreen;
+        }
         //NOTE: must be two times to change MouseState
         SDL_WarpMouse(screen_width / 2, screen_height / 2);
         SDL_WarpMouse(screen_width / 2, screen_height / 2);
@@ -171,13 +409,13 @@ VideoAgent::getVideoFlags()
     void
 VideoAgent::toggleFullScreen()
 {
-    int success = SDL_WM_ToggleFullScreen(m_screen);
+    int success = SDL_WM_ToggleFullScreen(m_display);
     if (success) {
         m_fullscreen = !m_fullscreen;
     }
     else {
         //NOTE: some platforms need reinit video
-        changeVideoMode(m_screen->w, m_screen->h);
+        changeVideoMode(m_display->w, m_display->h);
     }
 }
 //-----------------------------------------------------------------
@@ -205,6 +443,7 @@ VideoAgent::receiveSimple(const SimpleMsg *msg)
  * Handle incoming message.
  * Messages:
  * - param_changed(fullscreen) ... handle fullscreen
+ * - param_changed(fixed_scale) ... place backbuffer again
  *
  * @throws UnknownMsgException
  */
@@ -215,10 +454,16 @@ VideoAgent::receiveString(const StringMsg *msg)
         std::string param = msg->getValue();
         if ("fullscreen" == param) {
             bool fs = OptionAgent::agent()->getAsBool("fullscreen");
-            if (fs != m_fullscreen) {
+            if (fs != m_fullscreen && !m_offscreen) {
                 toggleFullScreen();
             }
         }
+        else if ("fixed_scale" == param) {
+            m_integerScale = OptionAgent::agent()->getAsBool("fixed_scale");
+            if (m_screen != m_display) {
+                updateLayout();
+            }
+        }
         else {
             throw UnknownMsgException(msg);
         }
@@ -2,10 +2,13 @@
 #define HEADER_VIDEOAGENT_H
 
 class Path;
+class FrameDump;
+class FrameCapture;
 
 #include "BaseAgent.h"
 #include "MultiDrawer.h"
 #include "Name.h"
+#include "V2.h"
 
 #include "SDL.h"
 
@@ -14,18 +17,39 @@ class Path;
 /**
  * Video agent initializes video mode and
  * every cycle lets registered drawers to drawOn(screen).
+ *
+ * Offscreen mode uses SDL dummy driver, frames are drawn
+ * into a software surface and they can be dumped to files.
+ *
+ * Fixed screen mode keeps one video mode, states draw
+ * into a backbuffer which is centered or integer scaled.
  */
 class VideoAgent : public BaseAgent, public MultiDrawer {
     AGENT(VideoAgent, Name::VIDEO_NAME);
     private:
         SDL_Surface *m_screen;
+        SDL_Surface *m_display;
         bool m_fullscreen;
+        bool m_fixedScreen;
+        bool m_integerScale;
+        bool m_clearDisplay;
+        int m_scale;
+        int m_offsetX;
+        int m_offsetY;
+        bool m_offscreen;
+        FrameDump *m_dump;
+        FrameCapture *m_capture;
 
     private:
         void setIcon(const Path &file);
         void changeVideoMode(int screen_width, int screen_height);
+        void changeBackBuffer(int screen_width, int screen_height);
+        void updateLayout();
+        void presentBackBuffer();
         int getVideoFlags();
         void toggleFullScreen();
+        void initFrameDump();
+        void initCapture();
     protected:
         virtual void own_init();
         virtual void own_update();
@@ -35,6 +59,7 @@ class VideoAgent : public BaseAgent, public MultiDrawer {
         virtual void receiveString(const StringMsg *msg);
 
         void initVideoMode();
+        V2 toScreenLoc(const V2 &displayLoc) const;
 };
 
 #endif
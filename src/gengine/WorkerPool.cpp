@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "WorkerPool.h"
+
+#include "RowTask.h"
+#include "Log.h"
+#include "SDLException.h"
+#include "LogicException.h"
+#include "OptionAgent.h"
+#include "minmax.h"
+
+#include <stdlib.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+WorkerPool *WorkerPool::ms_pool = NULL;
+
+//-----------------------------------------------------------------
+/**
+ * Start worker threads.
+ * @throws SDLException when synchronization cannot be created
+ */
+WorkerPool::WorkerPool(int threads)
+{
+    m_task = NULL;
+    m_rows = 0;
+    m_bands = 0;
+    m_nextBand = 0;
+    m_unfinished = 0;
+    m_generation = 0;
+    m_quit = false;
+
+    m_mutex = SDL_CreateMutex();
+    m_wake = SDL_CreateCond();
+    m_done = SDL_CreateCond();
+    if (NULL == m_mutex || NULL == m_wake || NULL == m_done) {
+        throw SDLException(ExInfo("CreateMutex"));
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        SDL_Thread *thread = SDL_CreateThread(workerMain, this);
+        if (NULL == thread) {
+            LOG_WARNING(ExInfo("cannot create worker thread")
+                    .addInfo("error", SDL_GetError()));
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Stop and wait for all workers.
+ */
+WorkerPool::~WorkerPool()
+{
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    SDL_CondBroadcast(m_wake);
+    SDL_UnlockMutex(m_mutex);
+
+    for (unsigned int i = 0; i < m_threads.size(); ++i) {
+        SDL_WaitThread(m_threads[i], NULL);
+    }
+    SDL_DestroyCond(m_done);
+    SDL_DestroyCond(m_wake);
+    SDL_DestroyMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Create shared pool.
+ * Use "worker_threads" option, default is one thread per spare cpu.
+ */
+void
+WorkerPool::init()
+{
+    int threads = OptionAgent::agent()->getAsInt("worker_threads",
+            countCpus() - 1);
+    threads = max(0, min(threads, 16));
+    if (NULL == ms_pool && threads > 0) {
+        ms_pool = new WorkerPool(threads);
+        LOG_INFO(ExInfo("worker pool")
+                .addInfo("threads", ms_pool->m_threads.size()));
+    }
+}
+//-----------------------------------------------------------------
+void
+WorkerPool::shutdown()
+{
+    delete ms_pool;
+    ms_pool = NULL;
+}
+//-----------------------------------------------------------------
+int
+WorkerPool::countCpus()
+{
+    int count = 1;
+#if defined(WIN32)
+    const char *env = getenv("NUMBER_OF_PROCESSORS");
+    if (env) {
+        count = atoi(env);
+    }
+#elif defined(_SC_NPROCESSORS_ONLN)
+    count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return max(1, count);
+}
+//-----------------------------------------------------------------
+int
+WorkerPool::workerMain(void *pool)
+{
+    static_cast<WorkerPool*>(pool)->work();
+    return 0;
+}
+//-----------------------------------------------------------------
+/**
+ * Wait for a new task and help with its bands.
+ */
+void
+WorkerPool::work()
+{
+    int seen = 0;
+    SDL_LockMutex(m_mutex);
+    while (true) {
+        while (!m_quit && m_generation == seen) {
+            SDL_CondWait(m_wake, m_mutex);
+        }
+        if (m_quit) {
+            break;
+        }
+        seen = m_generation;
+        SDL_UnlockMutex(m_mutex);
+
+        while (runBand()) {
+            /* empty */
+        }
+        SDL_LockMutex(m_mutex);
+    }
+    SDL_UnlockMutex(m_mutex);
+}
+//-----------------------------------------------------------------
+/**
+ * Take next unprocessed band and run it.
+ * Exceptions cannot leave a worker thread,
+ * the first error is kept for runTask().
+ * @return false when there is no band left
+ */
+bool
+WorkerPool::runBand()
+{
+    SDL_LockMutex(m_mutex);
+    if (m_nextBand >= m_bands) {
+        SDL_UnlockMutex(m_mutex);
+        return false;
+    }
+    int band = m_nextBand++;
+    RowTask *task = m_task;
+    int begin = band * m_rows / m_bands;
+    int end = (band + 1) * m_rows / m_bands;
+    SDL_UnlockMutex(m_mutex);
+
+    std::string error;
+    try {
+        task->runRows(begin, end);
+    }
+    catch (std::exception &e) {
+        error = e.what();
+    }
+    catch (...) {
+        error = "unknown exception";
+    }
+
+    SDL_LockMutex(m_mutex);
+    if (!error.empty() && m_error.empty()) {
+        m_error = error;
+    }
+    m_unfinished--;
+    if (0 == m_unfinished) {
+        SDL_CondSignal(m_done);
+    }
+    SDL_UnlockMutex(m_mutex);
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Split rows among workers and the caller.
+ * Returns after all bands are done.
+ * @throws LogicException when a band has failed
+ */
+void
+WorkerPool::runTask(RowTask *task, int rows)
+{
+    SDL_LockMutex(m_mutex);
+    m_task = task;
+    m_rows = rows;
+    m_bands = min(rows, static_cast<int>(m_threads.size()) + 1);
+    m_nextBand = 0;
+    m_unfinished = m_bands;
+    m_error.clear();
+    m_generation++;
+    SDL_CondBroadcast(m_wake);
+    SDL_UnlockMutex(m_mutex);
+
+    while (runBand()) {
+        /* empty */
+    }
+
+    SDL_LockMutex(m_mutex);
+    while (m_unfinished > 0) {
+        SDL_CondWait(m_done, m_mutex);
+    }
+    m_task = NULL;
+    std::string error = m_error;
+    SDL_UnlockMutex(m_mutex);
+
+    if (!error.empty()) {
+        throw LogicException(ExInfo("worker task failed")
+                .addInfo("error", error));
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Run task over all rows.
+ * Small passes and passes without pool run in the caller only.
+ * NOTE: must be called from the main thread only.
+ *
+ * @param task work for a band of rows, bands must be independent
+ * @param rows number of rows
+ * @param pixels number of touched pixels
+ */
+void
+WorkerPool::forRows(RowTask *task, int rows, int pixels)
+{
+    if (ms_pool && !ms_pool->m_threads.empty()
+            && pixels >= PARALLEL_PIXELS && rows > 1) {
+        ms_pool->runTask(task, rows);
+    }
+    else {
+        task->runRows(0, rows);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef HEADER_WORKERPOOL_H
+#define HEADER_WORKERPOOL_H
+
+class RowTask;
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <vector>
+#include <string>
+
+/**
+ * Persistent worker threads for full-screen passes.
+ * Rows are split into bands, the caller works on bands too.
+ */
+class WorkerPool : public NoCopy {
+    private:
+        static const int PARALLEL_PIXELS = 64 * 1024;
+        static WorkerPool *ms_pool;
+        std::vector<SDL_Thread*> m_threads;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_wake;
+        SDL_cond *m_done;
+        RowTask *m_task;
+        int m_rows;
+        int m_bands;
+        int m_nextBand;
+        int m_unfinished;
+        int m_generation;
+        std::string m_error;
+        bool m_quit;
+    private:
+        explicit WorkerPool(int threads);
+        static int countCpus();
+        static int workerMain(void *pool);
+        void work();
+        bool runBand();
+        void runTask(RowTask *task, int rows);
+    public:
+        ~WorkerPool();
+        static void init();
+        static void shutdown();
+
+        static void forRows(RowTask *task, int rows, int pixels);
+};
+
+#endif
@@ -11,8 +11,11 @@
 #include "Log.h"
 #include "Path.h"
 #include "ResImagePack.h"
+#include "ImageAtlas.h"
 #include "LogicException.h"
 #include "StringTool.h"
+#include "minmax.h"
+#include "TimerAgent.h"
 
 #include "EffectNone.h"
 #include "EffectMirror.h"
@@ -37,6 +40,8 @@
     m_specialAnimName = "";
     m_specialAnimPhase = 0;
     m_effect = new EffectNone();
+    m_revision = 0;
+    m_drawnCycle = -1;
 }
 //-----------------------------------------------------------------
 Anim::~Anim()
@@ -51,29 +56,135 @@ Anim::~Anim()
 /**
  * Draw anim phase at screen position.
  * Increase phase when anim is running.
+ * Phase and effect are updated only once per tick,
+ * more frames can be drawn between ticks.
  */
     void
 Anim::drawAt(SDL_Surface *screen, int x, int y, eSide side)
 {
+    int cycle = TimerAgent::agent()->getCycles();
+    bool tick = (cycle != m_drawnCycle);
+    m_drawnCycle = cycle;
+
     if (!m_effect->isInvisible()) {
         SDL_Surface *surface =
             m_animPack[side]->getRes(m_animName, m_animPhase);
-        m_effect->blit(screen, surface, x, y);
-        if (m_run) {
+        blit(screen, surface, x, y, side, false);
+        if (m_run && tick) {
             m_animPhase++;
             if (m_animPhase >= m_animPack[side]->countRes(m_animName)) {
                 m_animPhase = 0;
             }
+            m_revision++;
         }
 
         if (!m_specialAnimName.empty()) {
             surface =
                 m_animPack[side]->getRes(m_specialAnimName, m_specialAnimPhase);
-            m_effect->blit(screen, surface, x, y);
+            blit(screen, surface, x, y, side, false);
+        }
+    }
+
+    if (tick) {
+        m_effect->updateEffect();
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Draw current phase onto a transparent layer.
+ * Used only for static anims, the phase is not changed.
+ */
+    void
+Anim::drawOver(SDL_Surface *layer, int x, int y, eSide side)
+{
+    if (!m_effect->isInvisible()) {
+        SDL_Surface *surface =
+            m_animPack[side]->getRes(m_animName, m_animPhase);
+        blit(layer, surface, x, y, side, true);
+
+        if (!m_specialAnimName.empty()) {
+            surface =
+                m_animPack[side]->getRes(m_specialAnimName, m_specialAnimPhase);
+            blit(layer, surface, x, y, side, true);
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Blit surface through the effect.
+ * Trimmed surface is shifted by its offset
+ * or restored to the original size for effects which need it.
+ */
+    void
+Anim::blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y,
+        eSide side, bool over)
+{
+    const SDL_Rect *trim = m_animPack[side]->getTrim(surface);
+    if (trim) {
+        if (m_effect->canTrim()) {
+            x += trim->x;
+            y += trim->y;
+        }
+        else {
+            surface = m_animPack[side]->getUntrimmed(surface);
         }
     }
 
-    m_effect->updateEffect();
+    if (over) {
+        m_effect->blitOver(screen, surface, x, y);
+    }
+    else {
+        m_effect->blit(screen, surface, x, y);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Return size of the drawn phase.
+ * The special anim is included.
+ */
+    V2
+Anim::getSize(eSide side) const
+{
+    int w = 0;
+    int h = 0;
+    if (!m_effect->isInvisible()) {
+        SDL_Surface *surface =
+            m_animPack[side]->getRes(m_animName, m_animPhase);
+        const SDL_Rect *trim = m_animPack[side]->getTrim(surface);
+        w = trim ? trim->w : surface->w;
+        h = trim ? trim->h : surface->h;
+
+        if (!m_specialAnimName.empty()) {
+            surface =
+                m_animPack[side]->getRes(m_specialAnimName, m_specialAnimPhase);
+            trim = m_animPack[side]->getTrim(surface);
+            w = max(w, trim ? trim->w : surface->w);
+            h = max(h, trim ? trim->h : surface->h);
+        }
+    }
+    return V2(w, h);
+}
+//-----------------------------------------------------------------
+/**
+ * Add images from both sides to the atlas.
+ */
+    void
+Anim::collectImages(ImageAtlas *atlas) const
+{
+    m_animPack[SIDE_LEFT]->collectImages(atlas);
+    m_animPack[SIDE_RIGHT]->collectImages(atlas);
+}
+//-----------------------------------------------------------------
+/**
+ * Use packed images from the atlas.
+ * NOTE: the atlas must live longer than this anim.
+ */
+    void
+Anim::useAtlas(const ImageAtlas *atlas)
+{
+    m_animPack[SIDE_LEFT]->useAtlas(atlas);
+    m_animPack[SIDE_RIGHT]->useAtlas(atlas);
+    m_revision++;
 }
 //-----------------------------------------------------------------
 /**
@@ -85,6 +196,7 @@ Anim::addAnim(const std::string &name, const Path &picture, eSide side)
 {
     m_usedPath = picture.getPosixName();
     m_animPack[side]->addImage(name, picture);
+    m_revision++;
 }
 //-----------------------------------------------------------------
 /**
@@ -95,6 +207,7 @@ Anim::addAnim(const std::string &name, const Path &picture, eSide side)
 Anim::addAnim(const std::string &name, SDL_Surface *new_image, eSide side)
 {
     m_animPack[side]->addRes(name, new_image);
+    m_revision++;
 }
 //-----------------------------------------------------------------
 /**
@@ -107,7 +220,10 @@ Anim::runAnim(const std::string &name, int start_phase)
     if (m_animName != name) {
         setAnim(name, start_phase);
     }
-    m_run = true;
+    if (!m_run) {
+        m_run = true;
+        m_revision++;
+    }
 }
 //-----------------------------------------------------------------
 /**
@@ -116,6 +232,9 @@ Anim::runAnim(const std::string &name, int start_phase)
     void
 Anim::setAnim(const std::string &name, int phase)
 {
+    if (m_run || m_animName != name || m_animPhase != phase) {
+        m_revision++;
+    }
     m_run = false;
     m_animName = name;
     m_animPhase = phase;
@@ -146,6 +265,9 @@ Anim::setAnim(const std::string &name, int phase)
     void
 Anim::useSpecialAnim(const std::string &name, int phase)
 {
+    if (m_specialAnimName != name || m_specialAnimPhase != phase) {
+        m_revision++;
+    }
     m_specialAnimName = name;
     m_specialAnimPhase = phase;
     if (m_specialAnimName.empty()) {
@@ -183,6 +305,18 @@ Anim::changeEffect(ViewEffect *new_effect)
 
     delete m_effect;
     m_effect = new_effect;
+    m_revision++;
+}
+//-----------------------------------------------------------------
+void
+Anim::setViewShift(const V2 &shift)
+{
+    if (shift.getX() != m_viewShift.getX()
+            || shift.getY() != m_viewShift.getY())
+    {
+        m_viewShift = shift;
+        m_revision++;
+    }
 }
 //-----------------------------------------------------------------
     int
@@ -289,4 +423,5 @@ Anim::restoreState(const std::string &state)
 
     setEffect(effectName);
     m_viewShift = V2(x, y);
+    m_revision++;
 }
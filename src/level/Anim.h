@@ -3,6 +3,7 @@
 
 class Path;
 class ResImagePack;
+class ImageAtlas;
 
 #include "ViewEffect.h"
 #include "NoCopy.h"
@@ -29,13 +30,17 @@ class Anim : public NoCopy {
         std::string m_specialAnimName;
         int m_specialAnimPhase;
         std::string m_usedPath;
+        int m_revision;
+        int m_drawnCycle;
     private:
-        void blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y);
+        void blit(SDL_Surface *screen, SDL_Surface *surface, int x, int y,
+                eSide side, bool over);
     public:
         Anim();
         virtual ~Anim();
 
         void drawAt(SDL_Surface *screen, int x, int y, eSide side);
+        void drawOver(SDL_Surface *layer, int x, int y, eSide side);
 
         void addAnim(const std::string &name, const Path &picture,
                 eSide side=SIDE_LEFT);
@@ -48,10 +53,16 @@ class Anim : public NoCopy {
         bool isDisintegrated() const { return m_effect->isDisintegrated(); }
         bool isInvisible() const { return m_effect->isInvisible(); }
         void changeEffect(ViewEffect *new_effect);
-        void setViewShift(const V2 &shift) { m_viewShift = shift; }
+        void setViewShift(const V2 &shift);
         V2 getViewShift() const { return m_viewShift; };
         void setEffect(const std::string &effectName);
 
+        bool isStatic() const { return !m_run && m_effect->isStatic(); }
+        int getRevision() const { return m_revision; }
+        V2 getSize(eSide side) const;
+        void collectImages(ImageAtlas *atlas) const;
+        void useAtlas(const ImageAtlas *atlas);
+
         int countAnimPhases(const std::string &anim,
                 eSide side=SIDE_LEFT) const;
         std::string getState() const;
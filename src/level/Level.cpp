@@ -33,7 +33,11 @@
 #include "StatusDisplay.h"
 #include "Picture.h"
 #include "DialogStack.h"
-#include "StringTool.h"
+#include "ResImagePack.h"
+#include "RoomSnapshot.h"
+#include "ProfileDisplay.h"
+#include "ScriptProfiler.h"
+#include "ScriptState.h"
 
 #include <stdio.h>
 #include <assert.h>
@@ -58,10 +62,18 @@
     m_show = new CommandQueue();
     m_background = new MultiDrawer();
     m_statusDisplay = new StatusDisplay();
+    m_snapshot = NULL;
+    m_snapshotLoaded = false;
     takeHandler(new LevelInput(this));
     registerDrawable(m_background);
     registerDrawable(SubTitleAgent::agent());
     registerDrawable(m_statusDisplay);
+
+    m_profileDisplay = NULL;
+    if (m_levelScript->getProfiler()) {
+        m_profileDisplay = new ProfileDisplay(m_levelScript->getProfiler());
+        registerDrawable(m_profileDisplay);
+    }
 }
 //-----------------------------------------------------------------
 Level::~Level()
@@ -73,9 +85,13 @@ Level::~Level()
     delete m_show;
     delete m_countdown;
     delete m_loading;
+    if (m_levelScript->getProfiler()) {
+        m_levelScript->getProfiler()->writeReport(m_codename);
+    }
     delete m_levelScript;
     delete m_background;
     delete m_statusDisplay;
+    delete m_profileDisplay;
 }
 //-----------------------------------------------------------------
 void
@@ -105,7 +121,23 @@ Level::own_initState()
     }
     //TODO: escape "codename"
     m_levelScript->scriptDo("CODENAME = [[" + m_codename + "]]");
-    m_levelScript->scriptInclude(m_datafile);
+    ResImagePack::recordStart();
+    try {
+        m_levelScript->scriptInclude(m_datafile);
+    }
+    catch (...) {
+        ResImagePack::recordCancel();
+        throw;
+    }
+    ResImagePack::recordStop(m_codename);
+    if (m_levelScript->isRoom()
+            && OptionAgent::agent()->getAsBool("pack_images", true)) {
+        m_levelScript->room()->packImages();
+    }
+    if (OptionAgent::agent()->getAsBool("script_gc", true)) {
+        //NOTE: loading garbage is collected before the first frame
+        ScriptState::collectAll();
+    }
 }
 //-----------------------------------------------------------------
 /**
@@ -244,9 +276,7 @@ Level::saveUndo(const std::string &oldMoves)
         bool keepLast = m_wasDangerousMove;
         m_wasDangerousMove = room->stepCounter()->isDangerousMove();
 
-        std::string keepLastValue = keepLast ? "true" : "false";
-        m_levelScript->scriptDo("script_saveUndo(\""
-                + oldMoves + "\"," + keepLastValue + ")");
+        m_levelScript->scriptCall("script_saveUndo", oldMoves, keepLast);
     }
 }
 //-----------------------------------------------------------------
@@ -315,6 +345,13 @@ Level::saveGame(const std::string &models)
             fputs("\nsaved_models = ", saveFile);
             fputs(models.c_str(), saveFile);
             fclose(saveFile);
+
+            RoomSnapshot snapshot;
+            snapshot.capture(m_levelScript->room());
+            if (!snapshot.save(getSnapshotPath())) {
+                LOG_WARNING(ExInfo("cannot save snapshot")
+                        .addInfo("codename", m_codename));
+            }
             displaySaveStatus();
         }
         else {
@@ -335,8 +372,18 @@ Level::displaySaveStatus()
                 V2(0, 0)), TIME);
 }
 //-----------------------------------------------------------------
+/**
+ * Snapshot of models is saved next to the saved moves.
+ */
+    Path
+Level::getSnapshotPath() const
+{
+    return Path::dataWritePath("saves/" + m_codename + ".snap");
+}
+//-----------------------------------------------------------------
 /**
  * Start loading mode.
+ * A matching snapshot is restored directly without replay.
  * @param moves saved moves to load
  */
     void
@@ -347,6 +394,13 @@ Level::loadGame(const std::string &moves)
             m_levelScript->room()->setMoves(moves);
         }
     }
+    else if (m_snapshot && m_levelScript->isRoom()
+            && m_snapshot->restore(m_levelScript->room(), moves))
+    {
+        LOG_INFO(ExInfo("game is loaded from snapshot")
+                .addInfo("moves", moves.size()));
+        m_snapshotLoaded = true;
+    }
     else {
         m_loading->loadGame(moves);
     }
@@ -371,7 +425,7 @@ Level::nextLoadAction()
 {
     m_loading->nextLoadAction();
     if (!isLoading()) {
-        m_levelScript->scriptDo("script_loadState()");
+        m_levelScript->scriptCall("script_loadState");
     }
 }
 //-----------------------------------------------------------------
@@ -396,9 +450,7 @@ Level::nextUndoAction()
 {
     if (m_levelScript->isRoom()) {
         std::string moves = m_levelScript->room()->stepCounter()->getMoves();
-        std::string strSteps = StringTool::toString(m_undoSteps);
-        m_levelScript->scriptDo("script_loadUndo(\""
-               + moves + "\"," + strSteps + ")");
+        m_levelScript->scriptCall("script_loadUndo", moves, m_undoSteps);
     }
 }
 //-----------------------------------------------------------------
@@ -439,7 +491,7 @@ Level::action_move(char symbol)
 Level::action_save()
 {
     if (m_levelScript->room()->isSolvable()) {
-        m_levelScript->scriptDo("script_save()");
+        m_levelScript->scriptCall("script_save");
     }
     else {
         LOG_INFO(ExInfo("bad level condition, level cannot be finished, "
@@ -460,8 +512,26 @@ Level::action_load()
         m_undoSteps = 0;
         m_restartCounter--;
         action_restart(1);
-        m_levelScript->scriptInclude(file);
-        m_levelScript->scriptDo("script_load()");
+
+        RoomSnapshot snapshot;
+        Path snapshotFile = Path::dataReadPath(
+                "saves/" + m_codename + ".snap");
+        if (snapshotFile.exists() && snapshot.load(snapshotFile)) {
+            m_snapshot = &snapshot;
+        }
+        m_snapshotLoaded = false;
+        try {
+            m_levelScript->scriptInclude(file);
+            m_levelScript->scriptCall("script_load");
+        }
+        catch (...) {
+            m_snapshot = NULL;
+            throw;
+        }
+        m_snapshot = NULL;
+        if (m_snapshotLoaded) {
+            m_levelScript->scriptCall("script_loadState");
+        }
     }
     else {
         LOG_INFO(ExInfo("there is no file to load")
@@ -494,7 +564,7 @@ Level::action_undo_finish()
     }
 
     action_restart(0);
-    m_levelScript->scriptDo("script_loadFinalUndo()");
+    m_levelScript->scriptCall("script_loadFinalUndo");
     m_undoSteps = 0;
 }
 //-----------------------------------------------------------------
@@ -17,6 +17,8 @@ class CommandQueue;
 class Command;
 class MultiDrawer;
 class StatusDisplay;
+class RoomSnapshot;
+class ProfileDisplay;
 
 #include "Path.h"
 #include "GameState.h"
@@ -46,6 +48,9 @@ class Level : public GameState, public CountAdvisor {
         bool m_wasDangerousMove;
         MultiDrawer *m_background;
         StatusDisplay *m_statusDisplay;
+        ProfileDisplay *m_profileDisplay;
+        RoomSnapshot *m_snapshot;
+        bool m_snapshotLoaded;
     private:
         void initScreen();
         void nextAction();
@@ -58,6 +63,7 @@ class Level : public GameState, public CountAdvisor {
         void nextPlayerAction();
         void saveSolution();
         void displaySaveStatus();
+        Path getSnapshotPath() const;
         bool isUndoing() const;
     protected:
         virtual void own_initState();
@@ -90,6 +96,7 @@ class Level : public GameState, public CountAdvisor {
         void controlMouse(const MouseStroke &button);
 
         std::string getLevelName() const;
+        std::string getCodename() const { return m_codename; }
         int getRestartCounter() const { return m_restartCounter; }
         int getDepth() const { return m_depth; }
         bool isNewRound() const { return m_newRound; }
@@ -30,6 +30,10 @@ LevelInput::LevelInput(Level *level)
             KeyDesc(KEY_RESTART, "restart"));
     m_keymap->registerKey(KeyStroke(SDLK_F5, KMOD_NONE),
             KeyDesc(KEY_SHOW_STEPS, "show number of steps"));
+    if (OptionAgent::agent()->getAsBool("profile_scripts")) {
+        m_keymap->registerKey(KeyStroke(SDLK_F8, KMOD_NONE),
+                KeyDesc(KEY_SHOW_PROFILE, "show script profile"));
+    }
 
     KeyDesc undo = KeyDesc(KEY_UNDO, "undo");
     m_keymap->registerKey(KeyStroke(SDLK_MINUS, KMOD_NONE), undo);
@@ -83,6 +87,9 @@ LevelInput::specKey(int keyIndex)
         case KEY_SHOW_STEPS:
             toggleParam("show_steps");
             break;
+        case KEY_SHOW_PROFILE:
+            toggleParam("show_profile");
+            break;
         default:
             GameInput::specKey(keyIndex);
     }
@@ -19,6 +19,7 @@ class LevelInput : public GameInput {
         static const int KEY_UNDO = 105;
         static const int KEY_REDO = 106;
         static const int KEY_SHOW_STEPS = 107;
+        static const int KEY_SHOW_PROFILE = 108;
     private:
         Level *getLevel();
     protected:
@@ -16,6 +16,7 @@
 #include "LogicException.h"
 #include "Cube.h"
 #include "Unit.h"
+#include "OptionAgent.h"
 
 #include "game-script.h"
 #include "level-script.h"
@@ -30,6 +31,9 @@ LevelScript::LevelScript(Level *aLevel)
 {
     m_level = aLevel;
     registerGameFuncs();
+    if (OptionAgent::agent()->getAsBool("profile_scripts")) {
+        m_script->startProfiler();
+    }
 }
 //-----------------------------------------------------------------
 /**
@@ -51,7 +55,7 @@ LevelScript::createCommand(int funcRef)
     void
 LevelScript::updateScript()
 {
-    m_script->doString("script_update()");
+    m_script->callGlobal("script_update");
     satisfyPlan();
 }
 //-----------------------------------------------------------------
@@ -141,6 +145,7 @@ LevelScript::registerGameFuncs()
     m_script->registerFunc("model_isOut", script_model_isOut);
     m_script->registerFunc("model_isLeft", script_model_isLeft);
     m_script->registerFunc("model_isAtBorder", script_model_isAtBorder);
+    m_script->registerFunc("model_fillStates", script_model_fillStates);
     m_script->registerFunc("model_getW", script_model_getW);
     m_script->registerFunc("model_getH", script_model_getH);
     m_script->registerFunc("model_setGoal", script_model_setGoal);
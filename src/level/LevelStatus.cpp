@@ -13,6 +13,7 @@
 #include "ScriptState.h"
 #include "ScriptException.h"
 #include "DemoMode.h"
+#include "SolvedIndex.h"
 
 extern "C" {
 #include "lua.h"
@@ -82,12 +83,16 @@ LevelStatus::getSolutionFilename() const
 //-----------------------------------------------------------------
 /**
  * Read the best solution.
+ * Old solution file is imported into the solutions store.
  * @return saved_moves or empty string
  */
 std::string
 LevelStatus::readSolvedMoves()
 {
     m_savedMoves = "";
+    if (SolvedIndex::readMoves(m_codename, &m_savedMoves)) {
+        return m_savedMoves;
+    }
 
     Path oldSolution = Path::dataReadPath(getSolutionFilename());
     if (oldSolution.exists()) {
@@ -95,6 +100,7 @@ LevelStatus::readSolvedMoves()
             scriptDo("saved_moves=nil");
             scriptInclude(oldSolution);
             scriptDo("status_readMoves(saved_moves)");
+            SolvedIndex::noteSolved(m_codename, m_savedMoves);
         }
         catch (ScriptException &e) {
             LOG_WARNING(e.info());
@@ -105,26 +111,36 @@ LevelStatus::readSolvedMoves()
 }
 //-----------------------------------------------------------------
 /**
- * Write best solution to the file.
- * Save moves and models state.
+ * Return length of the best solution.
+ * The solution is read only when it is not imported yet.
+ * @return number of moves or -1 for unsolved level
+ */
+int
+LevelStatus::getSolvedMoveCount()
+{
+    if (!SolvedIndex::isSolved(m_codename)) {
+        return -1;
+    }
+
+    int moves = SolvedIndex::getMoves(m_codename);
+    if (moves < 0) {
+        moves = readSolvedMoves().size();
+    }
+    return moves;
+}
+//-----------------------------------------------------------------
+/**
+ * Store the best solution.
  */
     void
 LevelStatus::writeSolvedMoves(const std::string &moves)
 {
-    std::string prevMoves = readSolvedMoves();
+    int prevCount = getSolvedMoveCount();
 
-    if (prevMoves.empty() || moves.size() < prevMoves.size()) {
-        Path file = Path::dataWritePath(getSolutionFilename());
-        FILE *saveFile = fopen(file.getNative().c_str(), "w");
-        if (saveFile) {
-            fputs("\nsaved_moves = '", saveFile);
-            fputs(moves.c_str(), saveFile);
-            fputs("'\n", saveFile);
-            fclose(saveFile);
-        }
-        else {
+    if (prevCount <= 0 || static_cast<int>(moves.size()) < prevCount) {
+        if (!SolvedIndex::noteSolved(m_codename, moves)) {
             LOG_WARNING(ExInfo("cannot save solution")
-                    .addInfo("file", file.getNative())
+                    .addInfo("codename", m_codename)
                     .addInfo("moves", moves));
         }
     }
@@ -150,7 +166,7 @@ LevelStatus::createPoster() const
 int
 LevelStatus::compareToBest()
 {
-    int moves = readSolvedMoves().size();
+    int moves = getSolvedMoveCount();
     int result = 1;
     if (m_bestMoves > 0) {
         if (m_bestMoves < moves) {
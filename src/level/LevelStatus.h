@@ -36,6 +36,7 @@ class LevelStatus : public Scripter {
 
         void readMoves(const std::string &moves);
         std::string readSolvedMoves();
+        int getSolvedMoveCount();
         void writeSolvedMoves(const std::string &moves);
 
         static std::string getSolutionFilename(const std::string &codename);
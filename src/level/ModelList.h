@@ -17,6 +17,7 @@ class ModelList {
     public:
         ModelList(const Cube::t_models *models);
         int size() const { return m_models->size(); }
+        Cube *getModel(int index) const { return (*m_models)[index]; }
 
         void drawOn(View *view) const;
         bool stoneOn(Landslip *slip) const;
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "ProfileDisplay.h"
+
+#include "Font.h"
+#include "Path.h"
+#include "ScriptProfiler.h"
+#include "OptionAgent.h"
+#include "StringTool.h"
+
+//-----------------------------------------------------------------
+ProfileDisplay::ProfileDisplay(const ScriptProfiler *profiler)
+{
+    m_profiler = profiler;
+    m_font = NULL;
+    m_refreshTime = 0;
+}
+//-----------------------------------------------------------------
+ProfileDisplay::~ProfileDisplay()
+{
+    delete m_font;
+}
+//-----------------------------------------------------------------
+/**
+ * Draw report, it is refreshed once per second.
+ */
+void
+ProfileDisplay::drawOn(SDL_Surface *screen)
+{
+    if (!OptionAgent::agent()->getAsBool("show_profile")) {
+        return;
+    }
+    if (NULL == m_font) {
+        m_font = new Font(Path::dataReadPath("font/font_console.ttf"), 14);
+    }
+
+    Uint32 now = SDL_GetTicks();
+    if (m_lines.empty() || now >= m_refreshTime) {
+        m_lines = StringTool::split(m_profiler->getReport(LINES), '\n');
+        m_refreshTime = now + REFRESH_MS;
+    }
+
+    static const SDL_Color COLOR_YELLOW = {255, 255, 0, 255};
+    SDL_Rect rect;
+    rect.x = 10;
+    rect.y = 10;
+    for (unsigned int i = 0; i < m_lines.size(); ++i) {
+        if (m_lines[i].empty()) {
+            continue;
+        }
+        SDL_Surface *surface = m_font->renderTextOutlined(m_lines[i],
+                COLOR_YELLOW);
+        SDL_BlitSurface(surface, NULL, screen, &rect);
+        rect.y += m_font->getHeight();
+        SDL_FreeSurface(surface);
+    }
+}
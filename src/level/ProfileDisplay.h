@@ -0,0 +1,32 @@
+#ifndef HEADER_PROFILEDISPLAY_H
+#define HEADER_PROFILEDISPLAY_H
+
+class Font;
+class ScriptProfiler;
+
+#include "Drawable.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Live view of the hottest script functions.
+ * It is shown when "show_profile" option is set.
+ */
+class ProfileDisplay : public Drawable {
+    private:
+        static const unsigned int LINES = 12;
+        static const Uint32 REFRESH_MS = 1000;
+        const ScriptProfiler *m_profiler;
+        Font *m_font;
+        std::vector<std::string> m_lines;
+        Uint32 m_refreshTime;
+    public:
+        explicit ProfileDisplay(const ScriptProfiler *profiler);
+        virtual ~ProfileDisplay();
+        virtual void drawOn(SDL_Surface *screen);
+};
+
+#endif
@@ -16,6 +16,8 @@
 #include "PhaseLocker.h"
 #include "Planner.h"
 #include "View.h"
+#include "ImageAtlas.h"
+#include "Anim.h"
 
 #include "Log.h"
 #include "Rules.h"
@@ -55,7 +57,8 @@ Room::Room(int w, int h, const std::string &picture,
     m_field = new Field(w, h);
     m_finder = new FinderAlg(w, h);
     m_controls = new Controls(m_locker);
-    m_view = new View(ModelList(&m_models));
+    m_view = new View(ModelList(&m_models), m_bg);
+    m_atlas = NULL;
     m_lastAction = Cube::ACTION_NO;
     m_soundPack = new ResSoundPack();
     m_startTime = TimerAgent::agent()->getCycles();
@@ -79,6 +82,8 @@ Room::~Room()
     for (Cube::t_models::iterator i = m_models.begin(); i != end; ++i) {
         delete (*i);
     }
+    //NOTE: atlas pages are used by model anims
+    delete m_atlas;
 
     delete m_finder;
     delete m_field;
@@ -124,6 +129,31 @@ Room::addModel(Cube *new_model, Unit *new_unit)
     return model_index;
 }
 //-----------------------------------------------------------------
+/**
+ * Pack images of all models into a level atlas.
+ * Models added later keep their own images.
+ */
+    void
+Room::packImages()
+{
+    if (m_atlas) {
+        return;
+    }
+
+    m_atlas = new ImageAtlas();
+    Cube::t_models::iterator end = m_models.end();
+    for (Cube::t_models::iterator i = m_models.begin(); i != end; ++i) {
+        (*i)->const_anim()->collectImages(m_atlas);
+    }
+    m_atlas->pack();
+    for (Cube::t_models::iterator i = m_models.begin(); i != end; ++i) {
+        (*i)->anim()->useAtlas(m_atlas);
+    }
+    m_view->invalidateLayer();
+    LOG_DEBUG(ExInfo("packed level images")
+            .addInfo("pages", m_atlas->countPages()));
+}
+//-----------------------------------------------------------------
 /**
  * Return model at index.
  * @throws LogicException when model_index is out of range
@@ -525,13 +555,17 @@ Room::changeBg(const std::string &picture)
     if (picture != m_bgFilename) {
         m_bg->changePicture(Path::dataReadPath(picture));
         m_bgFilename = picture;
+        m_view->invalidateLayer();
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Draw background and models.
+ * NOTE: view draws the background into its static layer
+ */
     void
 Room::drawOn(SDL_Surface *screen)
 {
-    m_bg->drawOn(screen);
     m_view->drawOn(screen);
 }
 
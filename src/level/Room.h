@@ -16,6 +16,7 @@ class View;
 class Decor;
 class InputProvider;
 class StepCounter;
+class ImageAtlas;
 
 #include "Drawable.h"
 #include "Cube.h"
@@ -37,6 +38,7 @@ class Room : public Drawable {
         Planner *m_levelScript;
         View *m_view;
         Cube::t_models m_models;
+        ImageAtlas *m_atlas;
         Cube::eAction m_lastAction;
         int m_startTime;
         bool m_fastFalling;
@@ -57,6 +59,8 @@ class Room : public Drawable {
 
         int addModel(Cube *new_model, Unit *new_unit);
         Cube *getModel(int model_index);
+        int getModelCount() const { return m_models.size(); }
+        void packImages();
         Cube *askField(const V2 &loc);
 
         bool beginFall(bool interactive=true);
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "RoomSnapshot.h"
+
+#include "Path.h"
+#include "Room.h"
+#include "Cube.h"
+#include "Rules.h"
+#include "Anim.h"
+#include "StepCounter.h"
+#include "Log.h"
+
+#include <stdio.h>
+
+//-----------------------------------------------------------------
+/**
+ * Read one line without the newline.
+ * @return false at the end of file
+ */
+static bool
+readLine(FILE *file, std::string *line)
+{
+    line->clear();
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '\n') {
+        line->push_back(static_cast<char>(c));
+    }
+    return c != EOF || !line->empty();
+}
+//-----------------------------------------------------------------
+/**
+ * Store current state of all models.
+ */
+void
+RoomSnapshot::capture(Room *room)
+{
+    m_moves = room->stepCounter()->getMoves();
+    m_models.clear();
+    for (int i = 0; i < room->getModelCount(); ++i) {
+        Cube *model = room->getModel(i);
+        ModelState state;
+        state.loc = model->getLocation();
+        state.left = model->isLeft();
+        state.alive = model->isAlive();
+        state.lost = model->isLost();
+        state.out = model->isOut();
+        state.outDir = model->getOutDir();
+        state.outCapacity = model->getOutCapacity();
+        state.weight = model->getWeight();
+        state.anim = model->anim()->getState();
+        m_models.push_back(state);
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Format:
+ * "snapshot <version>", "moves:<moves>", "models <count>"
+ * and one line per model
+ * "<x> <y> <left> <alive> <lost> <out> <outDir> <outCapacity>
+ * <weight> <anim>".
+ * The file is replaced only after the new content is complete.
+ */
+bool
+RoomSnapshot::save(const Path &file) const
+{
+    std::string target = file.getNative();
+    std::string temp = target + ".tmp";
+    FILE *saveFile = fopen(temp.c_str(), "w");
+    if (NULL == saveFile) {
+        return false;
+    }
+
+    fprintf(saveFile, "snapshot %d\n", VERSION);
+    fprintf(saveFile, "moves:%s\n", m_moves.c_str());
+    fprintf(saveFile, "models %d\n", static_cast<int>(m_models.size()));
+    for (unsigned int i = 0; i < m_models.size(); ++i) {
+        const ModelState &state = m_models[i];
+        fprintf(saveFile, "%d %d %d %d %d %d %d %d %d %s\n",
+                state.loc.getX(), state.loc.getY(),
+                state.left, state.alive, state.lost, state.out,
+                state.outDir, state.outCapacity, state.weight,
+                state.anim.c_str());
+    }
+    bool result = !ferror(saveFile);
+    result = (0 == fclose(saveFile)) && result;
+#ifdef WIN32
+    if (result) {
+        remove(target.c_str());
+    }
+#endif
+    result = result && 0 == rename(temp.c_str(), target.c_str());
+    if (!result) {
+        remove(temp.c_str());
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Read saved snapshot.
+ * @return false for missing or invalid snapshot
+ */
+bool
+RoomSnapshot::load(const Path &file)
+{
+    m_moves.clear();
+    m_models.clear();
+    FILE *loadFile = fopen(file.getNative().c_str(), "r");
+    if (NULL == loadFile) {
+        return false;
+    }
+
+    static const std::string MOVES = "moves:";
+    std::string line;
+    int version = 0;
+    int count = -1;
+    bool result = readLine(loadFile, &line)
+        && 1 == sscanf(line.c_str(), "snapshot %d", &version)
+        && VERSION == version
+        && readLine(loadFile, &line)
+        && 0 == line.compare(0, MOVES.size(), MOVES)
+        && (m_moves = line.substr(MOVES.size()), readLine(loadFile, &line))
+        && 1 == sscanf(line.c_str(), "models %d", &count)
+        && count >= 0;
+
+    for (int i = 0; result && i < count; ++i) {
+        int x, y, left, alive, lost, out, used;
+        ModelState state;
+        result = readLine(loadFile, &line)
+            && 9 == sscanf(line.c_str(), "%d %d %d %d %d %d %d %d %d %n",
+                    &x, &y, &left, &alive, &lost, &out,
+                    &state.outDir, &state.outCapacity, &state.weight, &used);
+        if (result) {
+            state.loc = V2(x, y);
+            state.left = left;
+            state.alive = alive;
+            state.lost = lost;
+            state.out = out;
+            state.anim = line.substr(used);
+            m_models.push_back(state);
+        }
+    }
+    fclose(loadFile);
+
+    if (!result) {
+        LOG_WARNING(ExInfo("invalid snapshot")
+                .addInfo("file", file.getNative()));
+        m_models.clear();
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Restore models in a fresh room.
+ * The saved move log must match the snapshot.
+ * @param moves moves from the saved game
+ * @return false when snapshot cannot be used, room is untouched then
+ */
+bool
+RoomSnapshot::restore(Room *room, const std::string &moves) const
+{
+    if (moves != m_moves) {
+        LOG_WARNING(ExInfo("snapshot does not match saved moves"));
+        return false;
+    }
+    if (static_cast<int>(m_models.size()) != room->getModelCount()) {
+        LOG_WARNING(ExInfo("snapshot does not match room")
+                .addInfo("models", m_models.size())
+                .addInfo("room", room->getModelCount()));
+        return false;
+    }
+    for (unsigned int i = 0; i < m_models.size(); ++i) {
+        if (m_models[i].alive != room->getModel(i)->isAlive()) {
+            return false;
+        }
+    }
+
+    //NOTE: all models must be out of field before new positions are masked
+    for (unsigned int i = 0; i < m_models.size(); ++i) {
+        room->getModel(i)->rules()->unmask();
+    }
+    for (unsigned int i = 0; i < m_models.size(); ++i) {
+        const ModelState &state = m_models[i];
+        Cube *model = room->getModel(i);
+        //NOTE: setExtraParams() clears the lost flag, it must go first
+        model->setExtraParams();
+        if (model->isLeft() != state.left) {
+            model->change_turnSide();
+        }
+        model->setOutDir(static_cast<Dir::eDir>(state.outDir),
+                state.outCapacity, static_cast<Cube::eWeight>(state.weight));
+        model->anim()->restoreState(state.anim);
+        if (state.out) {
+            model->change_goOut();
+        }
+        else if (state.lost) {
+            model->change_remove();
+        }
+        else {
+            model->rules()->change_setLocation(state.loc);
+        }
+    }
+    room->setMoves(moves);
+
+    bool falling = true;
+    while (falling) {
+        falling = room->beginFall(false);
+        room->finishRound(false);
+    }
+    return true;
+}
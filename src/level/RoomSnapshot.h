@@ -0,0 +1,42 @@
+#ifndef HEADER_ROOMSNAPSHOT_H
+#define HEADER_ROOMSNAPSHOT_H
+
+class Path;
+class Room;
+
+#include "NoCopy.h"
+#include "V2.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Native snapshot of room models.
+ * It is saved next to the move log,
+ * so a saved game is restored without replay.
+ */
+class RoomSnapshot : public NoCopy {
+    private:
+        static const int VERSION = 2;
+        struct ModelState {
+            V2 loc;
+            bool left;
+            bool alive;
+            bool lost;
+            bool out;
+            int outDir;
+            int outCapacity;
+            int weight;
+            std::string anim;
+            ModelState() : loc(0, 0) {}
+        };
+        std::string m_moves;
+        std::vector<ModelState> m_models;
+    public:
+        void capture(Room *room);
+        bool save(const Path &file) const;
+        bool load(const Path &file);
+        bool restore(Room *room, const std::string &moves) const;
+};
+
+#endif
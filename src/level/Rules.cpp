@@ -20,6 +20,24 @@
 
 #include <assert.h>
 
+const char *Rules::ACTION_NAMES[] = {
+    "turn",
+    "activate",
+    "busy",
+    "move_left",
+    "move_right",
+    "move_up",
+    "move_down",
+    "rest"
+};
+const char *Rules::STATE_NAMES[] = {
+    "goout",
+    "dead",
+    "talking",
+    "pushing",
+    "normal"
+};
+
 //-----------------------------------------------------------------
 /**
  * Create new rules for model.
@@ -115,6 +133,16 @@ Rules::change_setLocation(const V2 &loc)
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Clear model from field.
+ * Used before models are moved to restored positions.
+ */
+    void
+Rules::unmask()
+{
+    m_mask->unmask();
+}
+//-----------------------------------------------------------------
 /**
  * Check dead fishes.
  * Fish is dead:
@@ -685,29 +713,29 @@ Rules::moveDirBrute(Dir::eDir dir)
  * Useful for script functions.
  * NOTE: dead is not action
  */
-std::string
-Rules::getAction() const
+Rules::eRoundAction
+Rules::getActionId() const
 {
     if (m_readyToTurn) {
-        return "turn";
+        return DO_TURN;
     }
     else if (m_readyToActive) {
-        return "activate";
+        return DO_ACTIVATE;
     }
     else if (m_model->isBusy()) {
-        return "busy";
+        return DO_BUSY;
     }
 
     switch (m_dir) {
-        case Dir::DIR_LEFT: return "move_left";
-        case Dir::DIR_RIGHT: return "move_right";
-        case Dir::DIR_UP: return "move_up";
-        case Dir::DIR_DOWN: return "move_down";
-        case Dir::DIR_NO: return "rest";
+        case Dir::DIR_LEFT: return DO_MOVE_LEFT;
+        case Dir::DIR_RIGHT: return DO_MOVE_RIGHT;
+        case Dir::DIR_UP: return DO_MOVE_UP;
+        case Dir::DIR_DOWN: return DO_MOVE_DOWN;
+        case Dir::DIR_NO: return DO_REST;
         default: assert(!"unknown dir"); break;
     }
 
-    return "rest";
+    return DO_REST;
 }
 //-----------------------------------------------------------------
 /**
@@ -721,23 +749,23 @@ Rules::getAction() const
  * "pushing" ... is pushing
  * "normal" ... is alive and resting
  */
-std::string
-Rules::getState() const
+Rules::eRoundState
+Rules::getStateId() const
 {
     if (m_outDepth == 1) {
-        return "goout";
+        return STATE_GOOUT;
     }
     else if (!m_model->isAlive()) {
-        return "dead";
+        return STATE_DEAD;
     }
     else if (m_model->isTalking()) {
-        return "talking";
+        return STATE_TALKING;
     }
     else if (m_pushing) {
-        return "pushing";
+        return STATE_PUSHING;
     }
     else {
-        return "normal";
+        return STATE_NORMAL;
     }
 }
 //-----------------------------------------------------------------
@@ -14,6 +14,28 @@ class OnCondition;
  * Game rules.
  */
 class Rules : public NoCopy {
+    public:
+        enum eRoundAction {
+            DO_TURN,
+            DO_ACTIVATE,
+            DO_BUSY,
+            DO_MOVE_LEFT,
+            DO_MOVE_RIGHT,
+            DO_MOVE_UP,
+            DO_MOVE_DOWN,
+            DO_REST,
+            DO_COUNT
+        };
+        enum eRoundState {
+            STATE_GOOUT,
+            STATE_DEAD,
+            STATE_TALKING,
+            STATE_PUSHING,
+            STATE_NORMAL,
+            STATE_COUNT
+        };
+        static const char *ACTION_NAMES[DO_COUNT];
+        static const char *STATE_NAMES[STATE_COUNT];
     private:
         Dir::eDir m_dir;
         bool m_readyToDie;
@@ -52,6 +74,7 @@ class Rules : public NoCopy {
         ~Rules();
         void takeField(Field *field);
         void change_setLocation(const V2 &loc);
+        void unmask();
 
         void occupyNewPos();
         bool checkDead(Cube::eAction lastAction);
@@ -67,8 +90,10 @@ class Rules : public NoCopy {
 
         Dir::eDir getDir() const { return m_dir; }
         Dir::eDir getTouchDir() const { return m_touchDir; }
-        std::string getAction() const;
-        std::string getState() const;
+        eRoundAction getActionId() const;
+        eRoundState getStateId() const;
+        std::string getAction() const { return ACTION_NAMES[getActionId()]; }
+        std::string getState() const { return STATE_NAMES[getStateId()]; }
         bool isOnStrongPad(Cube::eWeight weight);
         bool isAtBorder() const;
         bool isFreePlace(const V2 &loc) const;
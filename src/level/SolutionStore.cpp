@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "SolutionStore.h"
+
+#include "Log.h"
+
+#include <stdio.h>
+
+namespace {
+//-----------------------------------------------------------------
+void
+appendU32(std::string *out, Uint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+//-----------------------------------------------------------------
+bool
+readU32(FILE *file, Uint32 *value)
+{
+    unsigned char bytes[4];
+    if (fread(bytes, 4, 1, file) != 1) {
+        return false;
+    }
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16)
+        | (static_cast<Uint32>(bytes[3]) << 24);
+    return true;
+}
+}
+
+//-----------------------------------------------------------------
+/**
+ * Read index of the store.
+ * Missing or damaged file is an empty store.
+ */
+SolutionStore::SolutionStore(const std::string &file)
+    : m_file(file)
+{
+    if (!readIndex()) {
+        m_entries.clear();
+        m_dataStart = 0;
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Header: magic, version, count, reserved zero,
+ * then entries (name length, name, offset, length, moves, hash).
+ * Record offsets are relative to the end of the header.
+ * Store with records outside of the file is rejected.
+ */
+bool
+SolutionStore::readIndex()
+{
+    m_dataStart = 0;
+    FILE *file = fopen(m_file.c_str(), "rb");
+    if (NULL == file) {
+        return false;
+    }
+
+    bool result = false;
+    bool known = false;
+    Uint32 magic, version, count, unused;
+    if (readU32(file, &magic) && MAGIC == magic
+            && readU32(file, &version) && VERSION == version
+            && readU32(file, &count) && readU32(file, &unused))
+    {
+        known = true;
+        result = true;
+        for (Uint32 i = 0; i < count && result; ++i) {
+            Uint32 nameLength;
+            Entry entry;
+            result = readU32(file, &nameLength) && nameLength < 256;
+            std::string name(result ? nameLength : 0, '\0');
+            result = result
+                && (0 == nameLength || fread(&name[0], nameLength, 1, file) == 1)
+                && readU32(file, &entry.offset)
+                && readU32(file, &entry.length)
+                && readU32(file, &entry.moves)
+                && readU32(file, &entry.hash);
+            if (result) {
+                m_entries[name] = entry;
+            }
+        }
+        m_dataStart = ftell(file);
+        result = result && 0 == fseek(file, 0, SEEK_END)
+            && ftell(file) >= static_cast<long>(m_dataStart);
+        Uint32 dataSize = result ? ftell(file) - m_dataStart : 0;
+        t_entries::const_iterator end = m_entries.end();
+        for (t_entries::const_iterator i = m_entries.begin();
+                result && i != end; ++i) {
+            result = i->second.offset <= dataSize
+                && i->second.length <= dataSize - i->second.offset;
+        }
+    }
+    if (!result && (known || !feof(file) || ftell(file) > 0)) {
+        LOG_WARNING(ExInfo("bad solution store")
+                .addInfo("file", m_file));
+    }
+    fclose(file);
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Read all records.
+ * Files written by older versions can contain unused records.
+ */
+bool
+SolutionStore::readRecords(std::string *records) const
+{
+    records->clear();
+    if (0 == m_dataStart) {
+        return true;
+    }
+
+    FILE *file = fopen(m_file.c_str(), "rb");
+    if (NULL == file) {
+        return false;
+    }
+    bool result = (0 == fseek(file, m_dataStart, SEEK_SET));
+    char buffer[4096];
+    size_t got;
+    while (result && (got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        records->append(buffer, got);
+    }
+    result = result && !ferror(file);
+    fclose(file);
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Write complete store to a temp file and rename it over the old one.
+ * The old store stays intact when anything fails.
+ */
+bool
+SolutionStore::writeFile(const t_entries &entries,
+        const std::string &records, Uint32 *dataStart) const
+{
+    std::string header;
+    appendU32(&header, MAGIC);
+    appendU32(&header, VERSION);
+    appendU32(&header, entries.size());
+    appendU32(&header, 0);
+    t_entries::const_iterator end = entries.end();
+    for (t_entries::const_iterator i = entries.begin(); i != end; ++i) {
+        appendU32(&header, i->first.size());
+        header.append(i->first);
+        appendU32(&header, i->second.offset);
+        appendU32(&header, i->second.length);
+        appendU32(&header, i->second.moves);
+        appendU32(&header, i->second.hash);
+    }
+
+    *dataStart = header.size();
+
+    std::string temp = m_file + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    if (NULL == file) {
+        return false;
+    }
+    bool result = fwrite(header.data(), 1, header.size(), file)
+        == header.size();
+    result = result && (records.empty() || fwrite(records.data(), 1,
+                records.size(), file) == records.size());
+    result = (0 == fclose(file)) && result;
+#ifdef WIN32
+    if (result) {
+        remove(m_file.c_str());
+    }
+#endif
+    result = result && 0 == rename(temp.c_str(), m_file.c_str());
+    if (!result) {
+        remove(temp.c_str());
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+/**
+ * Keep only records referenced by entries.
+ * Entries outside of records are dropped.
+ */
+void
+SolutionStore::compact(t_entries *entries, std::string *records)
+{
+    std::string live;
+    t_entries::iterator i = entries->begin();
+    while (i != entries->end()) {
+        Entry &entry = i->second;
+        if (entry.offset > records->size()
+                || entry.length > records->size() - entry.offset) {
+            LOG_WARNING(ExInfo("dropped damaged solution record")
+                    .addInfo("codename", i->first));
+            entries->erase(i++);
+            continue;
+        }
+        Uint32 offset = live.size();
+        live.append(*records, entry.offset, entry.length);
+        entry.offset = offset;
+        ++i;
+    }
+    records->swap(live);
+}
+//-----------------------------------------------------------------
+/**
+ * FNV-1a hash of record data.
+ */
+Uint32
+SolutionStore::hash(const std::string &data)
+{
+    Uint32 result = 2166136261u;
+    for (std::string::size_type i = 0; i < data.size(); ++i) {
+        result ^= static_cast<unsigned char>(data[i]);
+        result *= 16777619u;
+    }
+    return result;
+}
+//-----------------------------------------------------------------
+bool
+SolutionStore::has(const std::string &codename) const
+{
+    return m_entries.find(codename) != m_entries.end();
+}
+//-----------------------------------------------------------------
+/**
+ * Return number of moves in stored solution.
+ * @return moves or -1 when there is no solution
+ */
+int
+SolutionStore::getMoves(const std::string &codename) const
+{
+    t_entries::const_iterator it = m_entries.find(codename);
+    return it == m_entries.end() ? -1 : static_cast<int>(it->second.moves);
+}
+//-----------------------------------------------------------------
+/**
+ * Read stored solution.
+ * @return false when there is no solution or the record is damaged
+ */
+bool
+SolutionStore::readMoves(const std::string &codename,
+        std::string *moves) const
+{
+    t_entries::const_iterator it = m_entries.find(codename);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    FILE *file = fopen(m_file.c_str(), "rb");
+    if (NULL == file) {
+        return false;
+    }
+    const Entry &entry = it->second;
+    std::string data(entry.length, '\0');
+    bool result = 0 == fseek(file, m_dataStart + entry.offset, SEEK_SET)
+        && (0 == entry.length
+                || fread(&data[0], entry.length, 1, file) == 1);
+    fclose(file);
+
+    if (!result || hash(data) != entry.hash) {
+        LOG_WARNING(ExInfo("damaged solution record")
+                .addInfo("file", m_file)
+                .addInfo("codename", codename));
+        return false;
+    }
+    moves->swap(data);
+    return true;
+}
+//-----------------------------------------------------------------
+/**
+ * Store a new solution and rewrite the store.
+ * Replaced record is dropped.
+ */
+bool
+SolutionStore::put(const std::string &codename, const std::string &moves)
+{
+    std::string records;
+    if (!readRecords(&records)) {
+        LOG_WARNING(ExInfo("cannot read solution store")
+                .addInfo("file", m_file));
+        return false;
+    }
+
+    t_entries entries = m_entries;
+    entries.erase(codename);
+    compact(&entries, &records);
+
+    Entry entry;
+    entry.offset = records.size();
+    entry.length = moves.size();
+    entry.moves = moves.size();
+    entry.hash = hash(moves);
+    entries[codename] = entry;
+    records.append(moves);
+
+    Uint32 dataStart;
+    if (!writeFile(entries, records, &dataStart)) {
+        LOG_WARNING(ExInfo("cannot write solution store")
+                .addInfo("file", m_file));
+        return false;
+    }
+    m_entries.swap(entries);
+    m_dataStart = dataStart;
+    return true;
+}
+//-----------------------------------------------------------------
+void
+SolutionStore::getCodenames(std::vector<std::string> *codenames) const
+{
+    t_entries::const_iterator end = m_entries.end();
+    for (t_entries::const_iterator i = m_entries.begin(); i != end; ++i) {
+        codenames->push_back(i->first);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef HEADER_SOLUTIONSTORE_H
+#define HEADER_SOLUTIONSTORE_H
+
+#include "NoCopy.h"
+
+#include "SDL.h"
+
+#include <string>
+#include <map>
+#include <vector>
+
+/**
+ * Single file with best solutions.
+ * Header contains index of records, records follow.
+ * Every change writes only live records
+ * and replaces the file by rename of a complete temp file.
+ */
+class SolutionStore : public NoCopy {
+    private:
+        static const Uint32 MAGIC = 0x42445346;
+        static const Uint32 VERSION = 1;
+        struct Entry {
+            Uint32 offset;
+            Uint32 length;
+            Uint32 moves;
+            Uint32 hash;
+        };
+        typedef std::map<std::string,Entry> t_entries;
+        std::string m_file;
+        t_entries m_entries;
+        Uint32 m_dataStart;
+    private:
+        bool readIndex();
+        bool readRecords(std::string *records) const;
+        bool writeFile(const t_entries &entries, const std::string &records,
+                Uint32 *dataStart) const;
+        static void compact(t_entries *entries, std::string *records);
+        static Uint32 hash(const std::string &data);
+    public:
+        explicit SolutionStore(const std::string &file);
+
+        bool has(const std::string &codename) const;
+        int getMoves(const std::string &codename) const;
+        bool readMoves(const std::string &codename, std::string *moves) const;
+        bool put(const std::string &codename, const std::string &moves);
+
+        void getCodenames(std::vector<std::string> *codenames) const;
+};
+
+#endif
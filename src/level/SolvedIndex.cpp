@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2004 Ivo Danihelka (ivo@danihelka.net)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+#include "SolvedIndex.h"
+
+#include "SolutionStore.h"
+#include "LevelStatus.h"
+
+#include "Path.h"
+#include "FsPath.h"
+#include "Log.h"
+#include "OptionAgent.h"
+
+#include <stdio.h>
+#include <vector>
+
+const char *SolvedIndex::STORE_FILE = "solved/solutions.db";
+SolvedIndex *SolvedIndex::ms_index = NULL;
+
+//-----------------------------------------------------------------
+/**
+ * Open solutions store and list old solution files.
+ * The store file is created by the first stored solution.
+ */
+SolvedIndex::SolvedIndex()
+{
+    Path store = Path::dataUserPath(STORE_FILE);
+    m_store = new SolutionStore(store.getNative());
+    addDir(Path::dataSystemPath("solved").getPosixName());
+    addDir(Path::dataUserPath("solved").getPosixName());
+
+    if (OptionAgent::agent()->getAsBool("export_solutions", false)) {
+        exportLegacy();
+    }
+}
+//-----------------------------------------------------------------
+SolvedIndex::~SolvedIndex()
+{
+    delete m_store;
+}
+//-----------------------------------------------------------------
+SolvedIndex *
+SolvedIndex::index()
+{
+    if (NULL == ms_index) {
+        ms_index = new SolvedIndex();
+    }
+    return ms_index;
+}
+//-----------------------------------------------------------------
+void
+SolvedIndex::shutdown()
+{
+    delete ms_index;
+    ms_index = NULL;
+}
+//-----------------------------------------------------------------
+/**
+ * Note all "<codename>.lua" files as old solutions.
+ */
+void
+SolvedIndex::addDir(const std::string &dir)
+{
+    static const std::string SUFFIX = ".lua";
+    std::vector<std::string> files;
+    std::vector<std::string> dirs;
+    FsPath::listDir(dir, &files, &dirs);
+    for (unsigned int i = 0; i < files.size(); ++i) {
+        const std::string &name = files[i];
+        if (name.size() > SUFFIX.size() && name.compare(
+                    name.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) == 0)
+        {
+            m_legacy.insert(name.substr(0, name.size() - SUFFIX.size()));
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Write all stored solutions as old "solved/<codename>.lua" files.
+ */
+void
+SolvedIndex::exportLegacy() const
+{
+    std::vector<std::string> codenames;
+    m_store->getCodenames(&codenames);
+    for (unsigned int i = 0; i < codenames.size(); ++i) {
+        std::string moves;
+        if (!m_store->readMoves(codenames[i], &moves)) {
+            continue;
+        }
+
+        Path file = Path::dataWritePath(
+                LevelStatus::getSolutionFilename(codenames[i]));
+        FILE *saveFile = fopen(file.getNative().c_str(), "w");
+        if (saveFile) {
+            fputs("\nsaved_moves = '", saveFile);
+            fputs(moves.c_str(), saveFile);
+            fputs("'\n", saveFile);
+            fclose(saveFile);
+        }
+        else {
+            LOG_WARNING(ExInfo("cannot export solution")
+                    .addInfo("file", file.getNative()));
+        }
+    }
+    LOG_INFO(ExInfo("exported solutions")
+            .addInfo("count", codenames.size()));
+}
+//-----------------------------------------------------------------
+bool
+SolvedIndex::isSolved(const std::string &codename)
+{
+    SolvedIndex *solved = index();
+    return solved->m_store->has(codename)
+        || solved->m_legacy.find(codename) != solved->m_legacy.end();
+}
+//-----------------------------------------------------------------
+/**
+ * Return number of moves in solution.
+ * @return moves or -1 for unsolved level or not imported solution
+ */
+int
+SolvedIndex::getMoves(const std::string &codename)
+{
+    return index()->m_store->getMoves(codename);
+}
+//-----------------------------------------------------------------
+/**
+ * Read solution from the store.
+ * @return false when the solution is not in the store
+ */
+bool
+SolvedIndex::readMoves(const std::string &codename, std::string *moves)
+{
+    return index()->m_store->readMoves(codename, moves);
+}
+//-----------------------------------------------------------------
+/**
+ * Store a new or imported solution.
+ */
+bool
+SolvedIndex::noteSolved(const std::string &codename,
+        const std::string &moves)
+{
+    SolvedIndex *solved = index();
+    //NOTE: make userdir path for the first solution
+    Path::dataWritePath(STORE_FILE);
+    return solved->m_store->put(codename, moves);
+}
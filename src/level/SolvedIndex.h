@@ -0,0 +1,39 @@
+#ifndef HEADER_SOLVEDINDEX_H
+#define HEADER_SOLVEDINDEX_H
+
+class SolutionStore;
+
+#include "NoCopy.h"
+
+#include <string>
+#include <set>
+
+/**
+ * Solved levels and their solutions.
+ * Solutions are kept in "solved/solutions.db" store.
+ * Old "solved/<codename>.lua" files are found by one listing
+ * and imported into the store when they are read first time.
+ */
+class SolvedIndex : public NoCopy {
+    private:
+        static const char *STORE_FILE;
+        static SolvedIndex *ms_index;
+        SolutionStore *m_store;
+        std::set<std::string> m_legacy;
+    private:
+        SolvedIndex();
+        static SolvedIndex *index();
+        void addDir(const std::string &dir);
+        void exportLegacy() const;
+    public:
+        virtual ~SolvedIndex();
+        static void shutdown();
+        static bool isSolved(const std::string &codename);
+        static int getMoves(const std::string &codename);
+        static bool readMoves(const std::string &codename,
+                std::string *moves);
+        static bool noteSolved(const std::string &codename,
+                const std::string &moves);
+};
+
+#endif
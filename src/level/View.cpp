@@ -15,24 +15,49 @@
 #include "Cube.h"
 #include "Anim.h"
 #include "Dir.h"
+#include "WavyPicture.h"
+#include "OptionAgent.h"
+#include "TimerAgent.h"
+#include "SDLException.h"
 #include "minmax.h"
 
+namespace {
+bool
+overlaps(const SDL_Rect &a, const SDL_Rect &b)
+{
+    return a.x < b.x + b.w && b.x < a.x + a.w
+        && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+}
+
 //-----------------------------------------------------------------
 /**
  * Create new view.
  * @param models wrapper arount models
+ * @param bg shared room background or NULL
  */
-View::View(const ModelList &models)
+View::View(const ModelList &models, WavyPicture *bg)
      : m_models(models), m_screenShift(0, 0)
 {
     m_animShift = 0;
+    m_lastShift = 0;
     m_shiftSize = SCALE;
+    m_shiftCycle = -1;
     m_screen = NULL;
+    m_bg = bg;
+    m_useLayer = OptionAgent::agent()->getAsBool("static_layer", true);
+    m_layer = NULL;
+    m_layerWavy = false;
+    m_layerValid = false;
+    m_stillCycle = -1;
 }
 //-----------------------------------------------------------------
 View::~View()
 {
     removeDecors();
+    if (m_layer) {
+        SDL_FreeSurface(m_layer);
+    }
 }
 //-----------------------------------------------------------------
 void
@@ -62,6 +87,7 @@ View::drawDecors()
 View::noteNewRound(int phases)
 {
     m_animShift = 0;
+    m_lastShift = 0;
     computeShiftSize(phases);
 }
 //-----------------------------------------------------------------
@@ -69,11 +95,223 @@ void
 View::drawOn(SDL_Surface *screen)
 {
     m_screen = screen;
-    m_animShift = min(SCALE, m_animShift + m_shiftSize);
-    m_models.drawOn(this);
+    updateAnimShift();
+    if (m_useLayer && m_bg) {
+        drawStatic();
+    }
+    else {
+        if (m_bg) {
+            m_bg->drawOn(screen);
+        }
+        m_models.drawOn(this);
+    }
     drawDecors();
 }
 //-----------------------------------------------------------------
+/**
+ * Blit static layer and draw only active models.
+ * Waving background stays under a transparent layer.
+ */
+void
+View::drawStatic()
+{
+    bool wavy = m_bg->isWavy();
+    updateTraces();
+    if (NULL == m_layer || wavy != m_layerWavy
+            || m_layer->w != m_screen->w || m_layer->h != m_screen->h)
+    {
+        prepareLayer(wavy);
+    }
+    if (!m_layerValid) {
+        redrawLayer(NULL);
+    }
+    else {
+        t_rects::iterator end = m_dirty.end();
+        for (t_rects::iterator i = m_dirty.begin(); i != end; ++i) {
+            redrawLayer(&(*i));
+        }
+    }
+    m_dirty.clear();
+
+    if (m_layerWavy) {
+        m_bg->drawOn(m_screen);
+    }
+    SDL_BlitSurface(m_layer, NULL, m_screen, NULL);
+
+    for (int i = 0; i < m_models.size(); ++i) {
+        if (!m_traces[i].layered) {
+            drawModel(m_models.getModel(i));
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Compare models with their last drawn state.
+ * A model goes to the static layer after STILL_ROUNDS without change.
+ * It must not overlap any earlier model drawn every frame,
+ * otherwise the drawing order would change.
+ * Areas of models which enter or leave the layer are marked dirty.
+ */
+void
+View::updateTraces()
+{
+    int cycle = TimerAgent::agent()->getCycles();
+    bool round = (cycle != m_stillCycle);
+    m_stillCycle = cycle;
+
+    int count = m_models.size();
+    if ((int)m_traces.size() != count) {
+        Trace fresh;
+        fresh.revision = -1;
+        fresh.x = 0;
+        fresh.y = 0;
+        fresh.left = false;
+        fresh.lost = false;
+        fresh.stillRounds = 0;
+        fresh.layered = false;
+        fresh.rect.x = 0;
+        fresh.rect.y = 0;
+        fresh.rect.w = 0;
+        fresh.rect.h = 0;
+        fresh.layerRect = fresh.rect;
+        m_traces.assign(count, fresh);
+        m_layerValid = false;
+    }
+
+    t_rects active;
+    for (int i = 0; i < count; ++i) {
+        Cube *model = m_models.getModel(i);
+        const Anim *anim = model->const_anim();
+        Trace &trace = m_traces[i];
+        V2 pos = getScreenPos(model);
+
+        bool same = trace.revision == anim->getRevision()
+            && trace.x == pos.getX() && trace.y == pos.getY()
+            && trace.left == model->isLeft()
+            && trace.lost == model->isLost();
+        if (same && anim->isStatic()) {
+            if (round && trace.stillRounds < STILL_ROUNDS) {
+                trace.stillRounds++;
+            }
+        }
+        else {
+            trace.stillRounds = 0;
+            trace.revision = anim->getRevision();
+            trace.x = pos.getX();
+            trace.y = pos.getY();
+            trace.left = model->isLeft();
+            trace.lost = model->isLost();
+
+            V2 size(0, 0);
+            if (!trace.lost) {
+                size = anim->getSize(trace.left ?
+                        Anim::SIDE_LEFT : Anim::SIDE_RIGHT);
+            }
+            trace.rect.x = trace.x;
+            trace.rect.y = trace.y;
+            trace.rect.w = size.getX();
+            trace.rect.h = size.getY();
+        }
+
+        bool layered = (trace.stillRounds >= STILL_ROUNDS);
+        for (unsigned int j = 0; layered && j < active.size(); ++j) {
+            if (overlaps(trace.rect, active[j])) {
+                layered = false;
+            }
+        }
+        if (!layered) {
+            active.push_back(trace.rect);
+        }
+
+        if (layered != trace.layered) {
+            trace.layered = layered;
+            if (layered) {
+                trace.layerRect = trace.rect;
+            }
+            m_dirty.push_back(trace.layerRect);
+        }
+    }
+}
+//-----------------------------------------------------------------
+/**
+ * Create layer surface for current screen.
+ * Opaque layer contains background,
+ * transparent layer is used when background is waving.
+ * @throws SDLException when surface cannot be created
+ */
+void
+View::prepareLayer(bool wavy)
+{
+    if (m_layer) {
+        SDL_FreeSurface(m_layer);
+        m_layer = NULL;
+    }
+
+    SDL_PixelFormat *format = m_screen->format;
+    if (wavy) {
+        m_layer = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                m_screen->w, m_screen->h, 32,
+                0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    }
+    else {
+        m_layer = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                m_screen->w, m_screen->h, format->BitsPerPixel,
+                format->Rmask, format->Gmask, format->Bmask, 0);
+    }
+    if (NULL == m_layer) {
+        throw SDLException(ExInfo("CreateRGBSurface"));
+    }
+    m_layerWavy = wavy;
+    m_layerValid = false;
+}
+//-----------------------------------------------------------------
+/**
+ * Draw background and layered models into the layer.
+ * @param area redrawn area or NULL for whole layer
+ */
+void
+View::redrawLayer(const SDL_Rect *area)
+{
+    if (area && (area->w == 0 || area->h == 0)) {
+        return;
+    }
+
+    SDL_SetClipRect(m_layer, area);
+    if (m_layerWavy) {
+        SDL_SetAlpha(m_layer, 0, SDL_ALPHA_OPAQUE);
+        SDL_FillRect(m_layer, NULL, 0);
+    }
+    else {
+        SDL_FillRect(m_layer, NULL, 0);
+        m_bg->drawOn(m_layer);
+    }
+
+    for (int i = 0; i < m_models.size(); ++i) {
+        const Trace &trace = m_traces[i];
+        if (trace.layered && !trace.lost
+                && (NULL == area || overlaps(trace.layerRect, *area)))
+        {
+            Anim::eSide side = Anim::SIDE_LEFT;
+            if (!trace.left) {
+                side = Anim::SIDE_RIGHT;
+            }
+            Anim *anim = m_models.getModel(i)->anim();
+            if (m_layerWavy) {
+                anim->drawOver(m_layer, trace.x, trace.y, side);
+            }
+            else {
+                anim->drawAt(m_layer, trace.x, trace.y, side);
+            }
+        }
+    }
+
+    if (m_layerWavy) {
+        SDL_SetAlpha(m_layer, SDL_SRCALPHA|SDL_RLEACCEL, SDL_ALPHA_OPAQUE);
+    }
+    SDL_SetClipRect(m_layer, NULL);
+    m_layerValid = true;
+}
+//-----------------------------------------------------------------
 /**
  * Draw model.
  * Care about model shift during move.
@@ -107,8 +345,24 @@ View::computeShiftSize(int phases)
     }
 }
 //-----------------------------------------------------------------
+/**
+ * Move anim one step further once per tick.
+ * Frames between ticks are interpolated in getScreenPos().
+ */
+    void
+View::updateAnimShift()
+{
+    int cycle = TimerAgent::agent()->getCycles();
+    if (cycle != m_shiftCycle) {
+        m_shiftCycle = cycle;
+        m_lastShift = m_animShift;
+        m_animShift = min(SCALE, m_animShift + m_shiftSize);
+    }
+}
+//-----------------------------------------------------------------
 /**
  * Returns position on screen when model will be drawn.
+ * Move shift is interpolated between the last two ticks.
  */
 V2
 View::getScreenPos(const Cube *model) const
@@ -116,8 +370,11 @@ View::getScreenPos(const Cube *model) const
     V2 shift(0, 0);
     Dir::eDir dir = model->getLastMoveDir();
     if (dir != Dir::DIR_NO) {
+        float fraction = TimerAgent::agent()->getTickFraction();
+        int animShift = static_cast<int>(0.5 + m_lastShift
+                + (m_animShift - m_lastShift) * fraction);
         shift = Dir::dir2xy(dir);
-        shift = shift.scale(m_animShift);
+        shift = shift.scale(animShift);
     }
     shift = shift.plus(m_screenShift);
 
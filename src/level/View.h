@@ -4,6 +4,7 @@
 class Cube;
 class PhaseLocker;
 class Decor;
+class WavyPicture;
 
 #include "Drawable.h"
 #include "ModelList.h"
@@ -11,26 +12,65 @@ class Decor;
 
 /**
  * View for model.
+ *
+ * Models which have not changed for a while are cached
+ * together with background in a static layer.
+ * Only active models are drawn every frame.
+ * The layer is redrawn only under models which enter or leave it.
  */
 class View : public Drawable {
     public:
         static const int SCALE = 15;
     private:
+        /**
+         * Last drawn state of one model.
+         */
+        class Trace {
+            public:
+            int revision;
+            int x;
+            int y;
+            bool left;
+            bool lost;
+            int stillRounds;
+            bool layered;
+            SDL_Rect rect;
+            SDL_Rect layerRect;
+        };
+        static const int STILL_ROUNDS = 2;
         typedef std::vector<Decor*> t_decors;
+        typedef std::vector<Trace> t_traces;
+        typedef std::vector<SDL_Rect> t_rects;
         t_decors m_decors;
         ModelList m_models;
         int m_animShift;
+        int m_lastShift;
         int m_shiftSize;
+        int m_shiftCycle;
         SDL_Surface *m_screen;
         V2 m_screenShift;
+        WavyPicture *m_bg;
+        bool m_useLayer;
+        SDL_Surface *m_layer;
+        bool m_layerWavy;
+        bool m_layerValid;
+        t_traces m_traces;
+        t_rects m_dirty;
+        int m_stillCycle;
     private:
         void computeShiftSize(int phases);
+        void updateAnimShift();
         void drawDecors();
+        void drawStatic();
+        void updateTraces();
+        void prepareLayer(bool wavy);
+        void redrawLayer(const SDL_Rect *area);
     public:
-        View(const ModelList &models);
+        View(const ModelList &models, WavyPicture *bg=NULL);
         virtual ~View();
         void setScreenShift(const V2 &shift) { m_screenShift = shift; }
         void noteNewRound(int phases);
+        void invalidateLayer() { m_layerValid = false; }
 
         void drawModel(Cube *model);
         virtual void drawOn(SDL_Surface *screen);
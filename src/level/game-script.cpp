@@ -481,6 +481,128 @@ script_model_isAtBorder(lua_State *L) throw()
     return 1;
 }
 //-----------------------------------------------------------------
+namespace {
+enum eField {
+    FIELD_X,
+    FIELD_Y,
+    FIELD_ACTION,
+    FIELD_STATE,
+    FIELD_DIR,
+    FIELD_TOUCHDIR,
+    FIELD_ALIVE,
+    FIELD_OUT,
+    FIELD_LEFT,
+    FIELD_COUNT
+};
+const char *FIELD_NAMES[FIELD_COUNT] = {
+    "x", "y", "action", "state", "dir", "touchDir", "alive", "out", "left"
+};
+const char NAMES_KEY = 'n';
+
+//-----------------------------------------------------------------
+/**
+ * Push registry table with interned strings.
+ * Field names are followed by action names and state names.
+ */
+void
+pushNames(lua_State *L)
+{
+    lua_pushlightuserdata(L, const_cast<char*>(&NAMES_KEY));
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    if (lua_istable(L, -1)) {
+        return;
+    }
+    lua_pop(L, 1);
+
+    lua_newtable(L);
+    int index = 1;
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        lua_pushstring(L, FIELD_NAMES[i]);
+        lua_rawseti(L, -2, index++);
+    }
+    for (int i = 0; i < Rules::DO_COUNT; ++i) {
+        lua_pushstring(L, Rules::ACTION_NAMES[i]);
+        lua_rawseti(L, -2, index++);
+    }
+    for (int i = 0; i < Rules::STATE_COUNT; ++i) {
+        lua_pushstring(L, Rules::STATE_NAMES[i]);
+        lua_rawseti(L, -2, index++);
+    }
+    lua_pushlightuserdata(L, const_cast<char*>(&NAMES_KEY));
+    lua_pushvalue(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+}
+//-----------------------------------------------------------------
+/**
+ * Set value from the stack top as a field of table below it.
+ */
+inline void
+setField(lua_State *L, int names, eField field)
+{
+    lua_rawgeti(L, names, 1 + field);
+    lua_insert(L, -2);
+    lua_rawset(L, -3);
+}
+}
+//-----------------------------------------------------------------
+/**
+ * table model_fillStates(table)
+ *
+ * Fill table[model_index] with state of every model.
+ * Fields: x, y, action, state, dir, touchDir, alive, out, left.
+ * Tables from the previous call are reused.
+ */
+    int
+script_model_fillStates(lua_State *L) throw()
+{
+    BEGIN_NOEXCEPTION;
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_settop(L, 1);
+    pushNames(L);
+    const int names = 2;
+    const int actions = 1 + FIELD_COUNT;
+    const int states = actions + Rules::DO_COUNT;
+
+    Room *room = getLevelScript(L)->room();
+    int count = room->getModelCount();
+    for (int i = 0; i < count; ++i) {
+        lua_rawgeti(L, 1, i);
+        if (!lua_istable(L, -1)) {
+            lua_pop(L, 1);
+            lua_newtable(L);
+            lua_pushvalue(L, -1);
+            lua_rawseti(L, 1, i);
+        }
+
+        Cube *model = room->getModel(i);
+        const Rules *rules = model->const_rules();
+        V2 loc = model->getLocation();
+        lua_pushnumber(L, loc.getX());
+        setField(L, names, FIELD_X);
+        lua_pushnumber(L, loc.getY());
+        setField(L, names, FIELD_Y);
+        lua_rawgeti(L, names, actions + rules->getActionId());
+        setField(L, names, FIELD_ACTION);
+        lua_rawgeti(L, names, states + rules->getStateId());
+        setField(L, names, FIELD_STATE);
+        lua_pushnumber(L, rules->getDir());
+        setField(L, names, FIELD_DIR);
+        lua_pushnumber(L, rules->getTouchDir());
+        setField(L, names, FIELD_TOUCHDIR);
+        lua_pushboolean(L, model->isAlive());
+        setField(L, names, FIELD_ALIVE);
+        lua_pushboolean(L, model->isOut());
+        setField(L, names, FIELD_OUT);
+        lua_pushboolean(L, model->isLeft());
+        setField(L, names, FIELD_LEFT);
+        lua_pop(L, 1);
+    }
+    lua_settop(L, 1);
+    END_NOEXCEPTION;
+    //NOTE: return table
+    return 1;
+}
+//-----------------------------------------------------------------
 /**
  * int model_getW(model_index)
  *
@@ -30,6 +30,7 @@ extern int script_model_isAlive(lua_State *L) throw();
 extern int script_model_isOut(lua_State *L) throw();
 extern int script_model_isLeft(lua_State *L) throw();
 extern int script_model_isAtBorder(lua_State *L) throw();
+extern int script_model_fillStates(lua_State *L) throw();
 extern int script_model_getW(lua_State *L) throw();
 extern int script_model_getH(lua_State *L) throw();
 extern int script_model_setGoal(lua_State *L) throw();
@@ -27,7 +27,7 @@ Pedometer::Pedometer(LevelStatus *status, Level *new_level)
 {
     m_level = new_level;
     m_status = status;
-    m_solution = m_status->readSolvedMoves();
+    m_solvedMoves = m_status->getSolvedMoveCount();
     m_meterPhase = 0;
     m_bg = NULL;
 
@@ -104,6 +104,7 @@ Pedometer::prepareRack()
     void
 Pedometer::own_initState()
 {
+    ResImagePack::prefetchList(m_level->getCodename());
     registerWatcher("lang");
     own_resumeState();
 }
@@ -172,13 +173,13 @@ Pedometer::runReplay()
     Level *levelState = m_level;
     m_level = NULL;
     changeState(levelState);
-    levelState->loadReplay(m_solution);
+    levelState->loadReplay(m_status->readSolvedMoves());
 }
 //-----------------------------------------------------------------
     void
 Pedometer::drawOn(SDL_Surface *screen)
 {
-    drawNumbers(screen, m_solution.size());
+    drawNumbers(screen, max(0, m_solvedMoves));
 }
 //-----------------------------------------------------------------
 /**
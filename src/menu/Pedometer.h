@@ -26,7 +26,7 @@ class Pedometer : public GameState, public Drawable {
         Uint32 m_maskRun;
         Uint32 m_maskReplay;
         Uint32 m_maskCancel;
-        std::string m_solution;
+        int m_solvedMoves;
         int m_meterPhase;
     private:
         void prepareBg();
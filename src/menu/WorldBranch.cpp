@@ -12,7 +12,7 @@
 #include "Log.h"
 #include "Path.h"
 #include "LevelNode.h"
-#include "LevelStatus.h"
+#include "SolvedIndex.h"
 #include "ScriptState.h"
 #include "ResDialogPack.h"
 #include "LevelDesc.h"
@@ -135,9 +135,7 @@ WorldBranch::bestSolution(const std::string &codename, int moves,
 bool
 WorldBranch::wasSolved(const std::string &codename)
 {
-    Path solved =
-        Path::dataReadPath(LevelStatus::getSolutionFilename(codename));
-    return solved.exists();
+    return SolvedIndex::isSolved(codename);
 }
 //-----------------------------------------------------------------
 /**
@@ -166,7 +166,11 @@ WorldMap::watchCursor()
     V2 mouseLoc = getInput()->getMouseLoc();
     if (!m_lastMouseLoc.equals(mouseLoc)) {
         m_lastMouseLoc = mouseLoc;
-        m_selected = m_startNode->findSelected(mouseLoc);
+        LevelNode *selected = m_startNode->findSelected(mouseLoc);
+        if (selected && selected != m_selected) {
+            ResImagePack::prefetchList(selected->getCodename());
+        }
+        m_selected = selected;
     }
 
     m_activeMask = m_bg->getMaskAtWorld(mouseLoc);
@@ -189,6 +193,9 @@ WorldMap::watchCursor()
 WorldMap::selectNextLevel()
 {
     m_selected = m_startNode->findNextOpen(m_selected);
+    if (m_selected) {
+        ResImagePack::prefetchList(m_selected->getCodename());
+    }
 }
 //-----------------------------------------------------------------
 /**
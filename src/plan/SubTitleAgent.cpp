@@ -14,6 +14,7 @@
 
 #include "Path.h"
 #include "OptionAgent.h"
+#include "TimerAgent.h"
 #include "minmax.h"
 
 //-----------------------------------------------------------------
@@ -34,7 +35,7 @@ SubTitleAgent::own_init()
     void
 SubTitleAgent::own_update()
 {
-    if (!m_titles.empty()) {
+    if (!m_titles.empty() && TimerAgent::agent()->isTick()) {
         shiftTitlesUp(TITLE_SPEED);
 
         if (m_titles.front()->isGone()) {
@@ -34,11 +34,9 @@ Title::Title(int baseY, int finalY, int bonusTime, int limitY,
     m_font = font;
     m_surface = m_font->renderTextOutlined(content, *color);
 
-    int text_width = m_font->calcTextWidth(content);
-
     m_screenW = OptionAgent::agent()->getAsInt("screen_width");
     m_screenH = OptionAgent::agent()->getAsInt("screen_height");
-    m_x = (m_screenW - text_width) / 2;
+    m_x = (m_screenW - m_surface->w) / 2;
     m_y = m_screenH - baseY;
     m_finalY = m_screenH - finalY;
     m_limitY = m_screenH - limitY;
@@ -111,7 +111,7 @@ DemoMode::drawOn(SDL_Surface *screen)
     if (m_display) {
         m_display->drawOn(m_surfaceBuffer);
     }
-    SDL_BlitSurface(m_surfaceBuffer, NULL, screen, NULL);
+    SurfaceTool::blitCopy(m_surfaceBuffer, screen, 0, 0);
 }
 
 